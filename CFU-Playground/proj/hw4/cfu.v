@@ -20,23 +20,246 @@ module Cfu (
   input      [9:0]    cmd_payload_function_id,
   input      [31:0]   cmd_payload_inputs_0,
   input      [31:0]   cmd_payload_inputs_1,
-  output              rsp_valid,
+  output reg          rsp_valid,
   input               rsp_ready,
-  output     [31:0]   rsp_payload_outputs_0,
+  output reg [31:0]   rsp_payload_outputs_0,
   input               reset,
   input               clk
 );
 
-  // Trivial handshaking for a combinational CFU
-  assign rsp_valid = cmd_valid;
-  assign cmd_ready = rsp_ready;
+  // funct3 0 is a 4-lane int8 SIMD MAC with four accumulators (see
+  // src/simd_cfu.h). Each op takes one cycle:
+  //   funct7 0..3: acc[n] += sum of rs1[byte i] * rs2[byte i], returns acc[n]
+  //   funct7 4..7: acc[n] = rs1, returns acc[n]
+  //
+  // funct3 1 is a single-precision float unit (see src/float_cfu.h):
+  //   funct7 0: rs1 * rs2
+  //   funct7 1: rs1 + rs2
+  //   funct7 2: acc = acc + rs1 * rs2, returns acc
+  //   funct7 3: acc = rs1, returns acc
+  // All arithmetic is one fused c + a * b with a single round to nearest
+  // even: multiply uses c = -0 and add uses b = 1.0. Subnormals flush to
+  // zero and NaN results are the canonical quiet NaN. float_fma() in
+  // src/software_cfu.cc is a bit-exact model.
+  //
+  // Other funct3 values pass an input through, as in the template.
+
+  parameter FUNCT3_SIMD = 3'd0;
+  parameter FUNCT3_FLOAT = 3'd1;
+  parameter FUNC_ID_MUL = 7'd0;
+  parameter FUNC_ID_ADD = 7'd1;
+  parameter FUNC_ID_MAC = 7'd2;
+  parameter FUNC_ID_SET_ACC = 7'd3;
+
+  parameter CANONICAL_NAN = 32'h7fc00000;
+  parameter INFINITY = 32'h7f800000;
+  parameter ONE = 32'h3f800000;
+  parameter NEGATIVE_ZERO = 32'h80000000;
+
+  wire [2:0] funct3 = cmd_payload_function_id[2:0];
+  wire [6:0] funct7 = cmd_payload_function_id[9:3];
+
+  //
+  // SIMD MAC.
+  //
+  wire signed [15:0] prod_0, prod_1, prod_2, prod_3;
+  assign prod_0 = $signed(cmd_payload_inputs_0[7 : 0])
+         * $signed(cmd_payload_inputs_1[7 : 0]);
+  assign prod_1 = $signed(cmd_payload_inputs_0[15: 8])
+         * $signed(cmd_payload_inputs_1[15: 8]);
+  assign prod_2 = $signed(cmd_payload_inputs_0[23:16])
+         * $signed(cmd_payload_inputs_1[23:16]);
+  assign prod_3 = $signed(cmd_payload_inputs_0[31:24])
+         * $signed(cmd_payload_inputs_1[31:24]);
+
+  wire signed [31:0] sum_prods;
+  assign sum_prods = prod_0 + prod_1 + prod_2 + prod_3;
+
+  reg  [31:0] simd_acc [0:3];
+  wire [1:0]  simd_sel = funct7[1:0];
+  wire        simd_is_mac = funct7[6:2] == 5'd0;
+  wire [31:0] simd_result = simd_is_mac ? simd_acc[simd_sel] + sum_prods :
+                                          cmd_payload_inputs_0;
+
+  //
+  // Float unit.
+  //
+  reg [31:0] acc;
+
+  // A float op takes three cycles: unpack and multiply, align and add,
+  // normalize and round.
+  reg [1:0] stage;
+  reg       stage_is_mac;
+
+  assign cmd_ready = ~rsp_valid & (stage == 2'd0);
 
   //
-  // select output -- note that we're not fully decoding the 3 function_id bits
+  // Stage 1: operand selection, special cases and the mantissa product.
   //
-  assign rsp_payload_outputs_0 = cmd_payload_function_id[0] ? 
-                                           cmd_payload_inputs_1 :
-                                           cmd_payload_inputs_0 ;
+  wire [31:0] a = cmd_payload_inputs_0;
+  wire [31:0] b = (funct7 == FUNC_ID_ADD) ? ONE : cmd_payload_inputs_1;
+  wire [31:0] c = (funct7 == FUNC_ID_ADD) ? cmd_payload_inputs_1 :
+                  (funct7 == FUNC_ID_MAC) ? acc : NEGATIVE_ZERO;
+
+  wire [7:0]  ea = a[30:23], eb = b[30:23], ec = c[30:23];
+  wire [22:0] ma = a[22:0], mb = b[22:0], mc = c[22:0];
+  wire        sp = a[31] ^ b[31];
+  wire        sc = c[31];
+
+  wire any_nan = (ea == 8'hff && ma != 0) || (eb == 8'hff && mb != 0) ||
+                 (ec == 8'hff && mc != 0);
+  wire p_inf  = ea == 8'hff || eb == 8'hff;
+  wire p_zero = ea == 8'h00 || eb == 8'h00;
+  wire c_inf  = ec == 8'hff;
+  wire c_zero = ec == 8'h00;
+
+  reg        special;
+  reg [31:0] special_value;
+  always @(*) begin
+    special = 1'b1;
+    if (any_nan)
+      special_value = CANONICAL_NAN;
+    else if (p_inf)
+      special_value = (p_zero || (c_inf && sc != sp)) ?
+                      CANONICAL_NAN : {sp, INFINITY[30:0]};
+    else if (c_inf)
+      special_value = c;
+    else if (p_zero)
+      special_value = c_zero ? {sp & sc, 31'b0} : c;
+    else begin
+      special = 1'b0;
+      special_value = 32'b0;
+    end
+  end
+
+  // Both addends are 48-bit integers: the product scaled by 2^lp and c's
+  // mantissa shifted up 24 bits and scaled by 2^lc. A zero c is an empty
+  // addend at the product's scale.
+  wire [47:0]        p  = {1'b1, ma} * {1'b1, mb};
+  wire signed [11:0] lp = $signed({4'b0, ea}) + $signed({4'b0, eb}) - 12'sd300;
+  wire signed [11:0] lc = c_zero ? lp : $signed({4'b0, ec}) - 12'sd174;
+
+  reg        s1_special;
+  reg [31:0] s1_special_value;
+  reg [47:0] s1_p, s1_cm;
+  reg signed [11:0] s1_lp, s1_lc;
+  reg        s1_sp, s1_sc;
+
+  //
+  // Stage 2: align the addend with the smaller scale, jamming shifted-out
+  // bits into its lowest bit, then add or subtract magnitudes.
+  //
+  wire               p_big = s1_lp >= s1_lc;
+  wire [50:0]        x     = {p_big ? s1_p : s1_cm, 3'b0};
+  wire [50:0]        y_in  = {p_big ? s1_cm : s1_p, 3'b0};
+  wire signed [11:0] diff  = p_big ? s1_lp - s1_lc : s1_lc - s1_lp;
+  wire [5:0]         shift = (diff > 12'sd63) ? 6'd63 : diff[5:0];
+  wire               sticky = (y_in & ~({51{1'b1}} << shift)) != 0;
+  wire [50:0]        y     = (y_in >> shift) | {50'b0, sticky};
+  wire               sx    = p_big ? s1_sp : s1_sc;
+  wire               sy    = p_big ? s1_sc : s1_sp;
+  wire               x_ge_y = x >= y;
+
+  reg        s2_special;
+  reg [31:0] s2_special_value;
+  reg [51:0] s2_magnitude;
+  reg        s2_sign;
+  reg signed [11:0] s2_lsb;
+
+  //
+  // Stage 3: normalize, round to nearest even, pack.
+  //
+  reg [5:0] msb;
+  integer i;
+  always @(*) begin
+    msb = 6'd0;
+    for (i = 0; i < 52; i = i + 1)
+      if (s2_magnitude[i]) msb = i;
+  end
+
+  wire signed [11:0] exponent = s2_lsb + $signed({6'b0, msb}) + 12'sd127;
+  wire [5:0]  round_shift = msb - 6'd23;
+  wire [51:0] rest_mask   = ~({52{1'b1}} << round_shift);
+  wire [51:0] rest        = s2_magnitude & rest_mask;
+  wire [51:0] half        = 52'd1 << (round_shift - 6'd1);
+  wire [24:0] truncated   = s2_magnitude >> round_shift;
+  wire        round_up    = rest > half || (rest == half && truncated[0]);
+  wire [24:0] rounded     = truncated + {24'b0, round_up};
+  wire [23:0] left_mantissa = s2_magnitude << (6'd23 - msb);
+
+  wire               needs_round = msb > 6'd23;
+  wire [23:0]        mantissa = !needs_round ? left_mantissa :
+                                rounded[24] ? rounded[24:1] : rounded[23:0];
+  wire signed [11:0] final_exponent =
+      exponent + ((needs_round && rounded[24]) ? 12'sd1 : 12'sd0);
+
+  reg [31:0] result;
+  always @(*) begin
+    if (s2_special)
+      result = s2_special_value;
+    else if (s2_magnitude == 0)
+      result = 32'b0;
+    else if (final_exponent >= 12'sd255)
+      result = {s2_sign, INFINITY[30:0]};
+    else if (final_exponent <= 12'sd0)
+      result = {s2_sign, 31'b0};
+    else
+      result = {s2_sign, final_exponent[7:0], mantissa[22:0]};
+  end
 
+  always @(posedge clk) begin
+    if (reset) begin
+      rsp_payload_outputs_0 <= 32'b0;
+      rsp_valid <= 1'b0;
+      acc <= 32'b0;
+      simd_acc[0] <= 32'b0;
+      simd_acc[1] <= 32'b0;
+      simd_acc[2] <= 32'b0;
+      simd_acc[3] <= 32'b0;
+      stage <= 2'd0;
+      stage_is_mac <= 1'b0;
+    end else if (rsp_valid) begin
+      // Waiting to hand off response to CPU.
+      rsp_valid <= ~rsp_ready;
+    end else if (stage == 2'd1) begin
+      s2_special <= s1_special;
+      s2_special_value <= s1_special_value;
+      s2_magnitude <= (sx == sy) ? {1'b0, x} + {1'b0, y} :
+                      x_ge_y ? {1'b0, x - y} : {1'b0, y - x};
+      s2_sign <= (sx == sy || x_ge_y) ? sx : sy;
+      s2_lsb <= (p_big ? s1_lp : s1_lc) - 12'sd3;
+      stage <= 2'd2;
+    end else if (stage == 2'd2) begin
+      rsp_payload_outputs_0 <= result;
+      if (stage_is_mac) acc <= result;
+      rsp_valid <= 1'b1;
+      stage <= 2'd0;
+    end else if (cmd_valid) begin
+      if (funct3 == FUNCT3_SIMD) begin
+        simd_acc[simd_sel] <= simd_result;
+        rsp_payload_outputs_0 <= simd_result;
+        rsp_valid <= 1'b1;
+      end else if (funct3 != FUNCT3_FLOAT) begin
+        rsp_payload_outputs_0 <= funct3[0] ? cmd_payload_inputs_1 :
+                                             cmd_payload_inputs_0;
+        rsp_valid <= 1'b1;
+      end else if (funct7 == FUNC_ID_SET_ACC) begin
+        acc <= cmd_payload_inputs_0;
+        rsp_payload_outputs_0 <= cmd_payload_inputs_0;
+        rsp_valid <= 1'b1;
+      end else begin
+        s1_special <= special;
+        s1_special_value <= special_value;
+        s1_p <= p;
+        s1_cm <= c_zero ? 48'b0 : {1'b1, mc, 24'b0};
+        s1_lp <= lp;
+        s1_lc <= lc;
+        s1_sp <= sp;
+        s1_sc <= sc;
+        stage_is_mac <= funct7 == FUNC_ID_MAC;
+        stage <= 2'd1;
+      end
+    end
+  end
 
 endmodule
@@ -0,0 +1,143 @@
+#!/bin/env python
+# Copyright 2023 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Writes src/arena_sizes.h from the tensor arena needs measured in simulation.
+
+  arena_sizes.py LOG SRC_DIR OUT.h
+
+LOG is the console output of a TF_LITE_ARENA_SIZING build that loaded every
+included model the way the application does. Each load prints a line (shown
+wrapped) such as
+
+  Arena: model 300568 bytes, 2 resident, needs 82400 (head 61440, tail 20960,
+  persistent buffers 1024)
+
+where the figures are for the model together with the models resident next
+to it (see tflite_add_model()): the tails of all of them plus the largest of
+their heads. A run in which a set of models did not fit next to each other
+measured them apart and is rejected.
+
+SRC_DIR is the composed source tree (build/src). A model is identified by its
+length: the calls passing (NAME, NAME_len) under SRC_DIR/models, such as
+tflite_load_model() or tflite_add_model(), give the arrays of each model
+directory, and NAME_len in any header gives the length of NAME.
+The size of a model directory is the largest need measured when one of its
+models was loaded, so it covers the models kept resident with them, and OUT.h
+defines it as TFLITE_ARENA_SIZE_<suffix of the INCLUDE_MODEL_ define>.
+"""
+
+import os
+import re
+import sys
+
+# Model directory under SRC_DIR/models -> suffix of its INCLUDE_MODEL_ define.
+MODEL_DIRS = {
+    'ds_cnn_stream_fe': 'DS_CNN_STREAM_FE',
+    'hps_model': 'HPS',
+    'magic_wand': 'MAGIC_WAND',
+    'micro_speech': 'MICRO_SPEECH',
+    'mlcommons_tiny_v01/anomd': 'MLCOMMONS_TINY_V01_ANOMD',
+    'mlcommons_tiny_v01/imgc': 'MLCOMMONS_TINY_V01_IMGC',
+    'mlcommons_tiny_v01/kws': 'MLCOMMONS_TINY_V01_KWS',
+    'mlcommons_tiny_v01/vww': 'MLCOMMONS_TINY_V01_VWW',
+    'mnv2': 'MNV2',
+    'pdti8': 'PDTI8',
+}
+
+ARENA_LINE = re.compile(
+    r'Arena: model (\d+) bytes, (\d+) resident, needs (\d+) \(head (\d+), '
+    r'tail (\d+), persistent buffers (\d+)\)')
+ARENA_FULL = 'Arena full: unloading'
+
+LOAD_CALL = re.compile(r'\(\s*(\w+)\s*,\s*\1_len\s*\)')
+LENGTH = re.compile(r'unsigned int (\w+)_len = (\d+);')
+
+
+def source_files(directory, extension):
+    for root, _, files in os.walk(directory):
+        for name in files:
+            if name.endswith(extension):
+                yield os.path.join(root, name)
+
+
+def model_names(src_dir):
+    """Returns {model length: define suffix}."""
+    lengths = {}
+    for path in source_files(src_dir, '.h'):
+        with open(path, errors='replace') as f:
+            for array, length in LENGTH.findall(f.read()):
+                lengths[array] = int(length)
+
+    names = {}
+    models_dir = os.path.join(src_dir, 'models')
+    for path in source_files(models_dir, '.cc'):
+        directory = os.path.relpath(os.path.dirname(path), models_dir)
+        if directory not in MODEL_DIRS:
+            continue
+        with open(path) as f:
+            arrays = LOAD_CALL.findall(f.read())
+        for array in arrays:
+            if array not in lengths:
+                continue
+            name = names.setdefault(lengths[array], MODEL_DIRS[directory])
+            if name != MODEL_DIRS[directory]:
+                sys.exit('%s and %s both have a %d byte model' %
+                         (name, MODEL_DIRS[directory], lengths[array]))
+    return names
+
+
+def main(argv):
+    if len(argv) != 4:
+        sys.exit(__doc__)
+    names = model_names(argv[2])
+
+    # Define suffix -> largest need, and a comment line per model.
+    sizes = {}
+    comments = {}
+    with open(argv[1], errors='replace') as f:
+        log = f.read()
+    if ARENA_FULL in log:
+        sys.exit('resident models were unloaded in %s; raise the arena size '
+                 'guesses in tflite.cc for the sizing run' % argv[1])
+    for match in ARENA_LINE.finditer(log):
+        length, resident, needs, head, tail, buffers = map(
+            int, match.groups())
+        if length not in names:
+            sys.exit('no model of %d bytes under %s' % (length, argv[2]))
+        name = names[length]
+        sizes[name] = max(needs, sizes.get(name, 0))
+        comment = ('// %d byte model, %d resident: head %d, tail %d '
+                   '(persistent buffers %d)' %
+                   (length, resident, head, tail, buffers))
+        if comment not in comments.setdefault(name, []):
+            comments[name].append(comment)
+    if not sizes:
+        sys.exit('no arena sizes in %s; was it built with TF_LITE_ARENA_SIZING?'
+                 % argv[1])
+
+    with open(argv[3], 'w') as f:
+        f.write('// Generated by scripts/arena_sizes.py from a '
+                'TF_LITE_ARENA_SIZING run.\n')
+        f.write('// Exact tensor arena bytes per INCLUDE_MODEL_ define.\n')
+        f.write('\n#ifndef _ARENA_SIZES_H\n#define _ARENA_SIZES_H\n')
+        for name in sorted(sizes):
+            f.write('\n%s\n' % '\n'.join(comments[name]))
+            f.write('#define TFLITE_ARENA_SIZE_%s %d\n' % (name, sizes[name]))
+        f.write('\n#endif  // _ARENA_SIZES_H\n')
+    for name in sorted(sizes):
+        print('%s: %d bytes' % (name, sizes[name]))
+
+
+if __name__ == '__main__':
+    main(sys.argv)
@@ -0,0 +1,259 @@
+#!/bin/env python
+# Copyright 2023 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Gives a quantized .tflite model an int8 input and output boundary.
+
+  int8_io.py strip MODEL.tflite OUT.tflite
+      Removes a QUANTIZE op that turns a float graph input into int8, and a
+      DEQUANTIZE op that turns an int8 result into a float graph output, so
+      the int8 tensors become the graph input and output.
+
+  int8_io.py quantize MODEL.tflite LABEL_board.cc OUT.dat
+      Quantizes the float array in LABEL_board.cc with the input quantization
+      of MODEL.tflite (an already stripped model) and writes raw int8 bytes.
+
+The model is patched in place in its flatbuffer: only the subgraph input,
+output and operator vectors and the orphaned float tensor shapes change, so
+no flatbuffers package is needed.
+"""
+
+import re
+import struct
+import sys
+
+BUILTIN_DEQUANTIZE = 6
+BUILTIN_QUANTIZE = 114
+TENSOR_FLOAT32 = 0
+TENSOR_INT8 = 9
+
+
+class FlatBuffer:
+
+    def __init__(self, data):
+        self.data = data
+
+    def u8(self, pos):
+        return self.data[pos]
+
+    def i8(self, pos):
+        return struct.unpack_from('<b', self.data, pos)[0]
+
+    def u16(self, pos):
+        return struct.unpack_from('<H', self.data, pos)[0]
+
+    def i32(self, pos):
+        return struct.unpack_from('<i', self.data, pos)[0]
+
+    def u32(self, pos):
+        return struct.unpack_from('<I', self.data, pos)[0]
+
+    def set_u32(self, pos, value):
+        struct.pack_into('<I', self.data, pos, value)
+
+    def root(self):
+        return self.u32(0)
+
+    def field(self, table, index):
+        """Position of a table field, or None if it holds the default."""
+        vtable = table - self.i32(table)
+        entry = 4 + 2 * index
+        if entry >= self.u16(vtable):
+            return None
+        offset = self.u16(vtable + entry)
+        return table + offset if offset else None
+
+    def deref(self, pos):
+        return pos + self.u32(pos)
+
+    def table(self, table, index):
+        pos = self.field(table, index)
+        return self.deref(pos) if pos is not None else None
+
+    def vector(self, table, index):
+        """Position of the first element and length of a vector field."""
+        pos = self.table(table, index)
+        if pos is None:
+            return None, 0
+        return pos + 4, self.u32(pos)
+
+    def tables(self, table, index):
+        start, length = self.vector(table, index)
+        return [self.deref(start + 4 * i) for i in range(length)]
+
+    def ints(self, table, index):
+        start, length = self.vector(table, index)
+        return [self.i32(start + 4 * i) for i in range(length)]
+
+    def scalar(self, table, index, read, default=0):
+        pos = self.field(table, index)
+        return read(pos) if pos is not None else default
+
+
+# Field indices from tensorflow/lite/schema/schema.fbs.
+MODEL_OPERATOR_CODES, MODEL_SUBGRAPHS, MODEL_SIGNATURE_DEFS = 1, 2, 7
+SUBGRAPH_TENSORS, SUBGRAPH_INPUTS, SUBGRAPH_OUTPUTS, SUBGRAPH_OPERATORS = (
+    0, 1, 2, 3)
+OPERATOR_OPCODE_INDEX, OPERATOR_INPUTS, OPERATOR_OUTPUTS = 0, 1, 2
+OPCODE_DEPRECATED_BUILTIN_CODE, OPCODE_BUILTIN_CODE = 0, 3
+TENSOR_SHAPE, TENSOR_TYPE, TENSOR_QUANTIZATION = 0, 1, 4
+QUANTIZATION_SCALE, QUANTIZATION_ZERO_POINT = 2, 3
+SIGNATURE_INPUTS, SIGNATURE_OUTPUTS = 0, 1
+TENSOR_MAP_TENSOR_INDEX = 1
+
+
+def builtin_code(fb, opcode):
+    code = fb.scalar(opcode, OPCODE_BUILTIN_CODE, fb.i32)
+    deprecated = fb.scalar(opcode, OPCODE_DEPRECATED_BUILTIN_CODE, fb.i8)
+    return max(code, deprecated)
+
+
+def tensor_type(fb, tensor):
+    return fb.scalar(tensor, TENSOR_TYPE, fb.i8)
+
+
+def strip(fb):
+    model = fb.root()
+    opcodes = fb.tables(model, MODEL_OPERATOR_CODES)
+    subgraph = fb.tables(model, MODEL_SUBGRAPHS)[0]
+    tensors = fb.tables(subgraph, SUBGRAPH_TENSORS)
+    operators = fb.tables(subgraph, SUBGRAPH_OPERATORS)
+
+    def boundary_op(tensor, code, io_index, from_type, to_type):
+        """The single-tensor op of the given kind touching a graph tensor."""
+        for i, op in enumerate(operators):
+            inputs = fb.ints(op, OPERATOR_INPUTS)
+            outputs = fb.ints(op, OPERATOR_OUTPUTS)
+            if len(inputs) != 1 or len(outputs) != 1:
+                continue
+            if (inputs, outputs)[io_index][0] != tensor:
+                continue
+            opcode = opcodes[fb.scalar(op, OPERATOR_OPCODE_INDEX, fb.u32)]
+            if (builtin_code(fb, opcode) == code and
+                    tensor_type(fb, tensors[inputs[0]]) == from_type and
+                    tensor_type(fb, tensors[outputs[0]]) == to_type):
+                return i, (outputs, inputs)[io_index][0]
+        return None, None
+
+    removed = set()
+    renamed = {}
+    for vector_index, io_index, code, from_type, to_type in (
+            (SUBGRAPH_INPUTS, 0, BUILTIN_QUANTIZE, TENSOR_FLOAT32, TENSOR_INT8),
+            (SUBGRAPH_OUTPUTS, 1, BUILTIN_DEQUANTIZE, TENSOR_INT8,
+             TENSOR_FLOAT32)):
+        start, length = fb.vector(subgraph, vector_index)
+        for i in range(length):
+            tensor = fb.i32(start + 4 * i)
+            op, replacement = boundary_op(tensor, code, io_index, from_type,
+                                          to_type)
+            if op is None:
+                continue
+            # The stripped op's other tensor must not feed anything else.
+            readers = [o for o in operators
+                       if tensor in fb.ints(o, OPERATOR_INPUTS)]
+            if io_index == 0 and len(readers) != 1:
+                continue
+            fb.set_u32(start + 4 * i, replacement)
+            removed.add(op)
+            renamed[tensor] = replacement
+
+    if not removed:
+        sys.exit('no boundary QUANTIZE/DEQUANTIZE ops found')
+
+    # Compact the operator vector. Elements are offsets relative to their own
+    # slot, so every kept entry is re-based as it moves down.
+    start, length = fb.vector(subgraph, SUBGRAPH_OPERATORS)
+    kept = [op for i, op in enumerate(operators) if i not in removed]
+    for i, op in enumerate(kept):
+        fb.set_u32(start + 4 * i, op - (start + 4 * i))
+    fb.set_u32(start - 4, len(kept))
+
+    # The float boundary tensors are now orphans. TFLM still plans arena space
+    # for any tensor with a non-zero byte length, so give them an empty shape.
+    for tensor in renamed:
+        start, length = fb.vector(tensors[tensor], TENSOR_SHAPE)
+        if length:
+            fb.set_u32(start, 0)
+
+    # TFLM ignores signatures, but keep them consistent when the index is
+    # actually stored (a default index of 0 is omitted and cannot be patched).
+    for signature in fb.tables(model, MODEL_SIGNATURE_DEFS):
+        for maps in (SIGNATURE_INPUTS, SIGNATURE_OUTPUTS):
+            for tensor_map in fb.tables(signature, maps):
+                pos = fb.field(tensor_map, TENSOR_MAP_TENSOR_INDEX)
+                old = fb.u32(pos) if pos is not None else 0
+                if old in renamed:
+                    if pos is None:
+                        print('warning: signature tensor %d not patched' % old)
+                    else:
+                        fb.set_u32(pos, renamed[old])
+
+    for old, new in sorted(renamed.items()):
+        print('boundary tensor %d -> %d' % (old, new))
+    print('removed %d of %d operators' % (len(removed), len(operators)))
+
+
+def input_quantization(fb):
+    model = fb.root()
+    subgraph = fb.tables(model, MODEL_SUBGRAPHS)[0]
+    tensors = fb.tables(subgraph, SUBGRAPH_TENSORS)
+    tensor = tensors[fb.ints(subgraph, SUBGRAPH_INPUTS)[0]]
+    if tensor_type(fb, tensor) != TENSOR_INT8:
+        sys.exit('model input is not int8; strip it first')
+    quantization = fb.table(tensor, TENSOR_QUANTIZATION)
+    start, _ = fb.vector(quantization, QUANTIZATION_SCALE)
+    scale = struct.unpack_from('<f', fb.data, start)[0]
+    start, length = fb.vector(quantization, QUANTIZATION_ZERO_POINT)
+    zero_point = struct.unpack_from('<q', fb.data, start)[0] if length else 0
+    return scale, zero_point
+
+
+def to_float32(value):
+    return struct.unpack('<f', struct.pack('<f', value))[0]
+
+
+def quantize(fb, source):
+    """Matches AffineQuantize in reference/quantize.h, including the float32
+    division and round-half-away-from-zero."""
+    scale, zero_point = input_quantization(fb)
+    with open(source) as f:
+        body = f.read().split('{', 1)[1].split('}', 1)[0]
+    values = [float(v) for v in re.split(r'[\s,]+', body) if v]
+    result = bytearray()
+    for value in values:
+        scaled = to_float32(to_float32(value) / scale)
+        rounded = int(scaled + 0.5) if scaled >= 0 else -int(-scaled + 0.5)
+        result += struct.pack('<b', max(-128, min(127, rounded + zero_point)))
+    print('%d values, scale %g, zero point %d' % (len(values), scale,
+                                                   zero_point))
+    return result
+
+
+def main(argv):
+    if len(argv) == 4 and argv[1] == 'strip':
+        with open(argv[2], 'rb') as f:
+            fb = FlatBuffer(bytearray(f.read()))
+        strip(fb)
+        with open(argv[3], 'wb') as f:
+            f.write(fb.data)
+    elif len(argv) == 5 and argv[1] == 'quantize':
+        with open(argv[2], 'rb') as f:
+            fb = FlatBuffer(bytearray(f.read()))
+        with open(argv[4], 'wb') as f:
+            f.write(quantize(fb, argv[3]))
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == '__main__':
+    main(sys.argv)
@@ -0,0 +1,361 @@
+#!/bin/env python
+# Copyright 2023 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Plans a model's activation memory offline and embeds the plan in it.
+
+  offline_plan.py report MODEL.tflite...
+      Prints, for each model, the arena head its activations need with
+      TFLM's GreedyMemoryPlanner, with the plan found here, and the lower
+      bound (the most bytes live at once).
+
+  offline_plan.py embed MODEL.tflite OUT.tflite
+      Writes the model with the plan found here as "OfflineMemoryAllocation"
+      metadata, which MicroAllocator uses in place of planning those tensors
+      at boot.
+
+Tensor lifetimes and sizes follow AllocationInfoBuilder and CreatePlan in
+TFLM. Buffers are placed first-fit, like the greedy planner, in several
+orders; random swaps of the best order are then kept while they do not grow
+the plan. A plan equal to the lower bound is optimal.
+
+Kernel scratch buffers are not known until the kernels are prepared, so
+they are still planned at boot, into the gaps of the offline plan or after
+it. Those and the tensors' real lifetimes in the interpreter can make the
+head at boot differ from the figures here, so compare the embedded model
+with a TF_LITE_ARENA_SIZING run before keeping it. TFLM reads the offline
+offsets per subgraph as if they were subgraph 0's, so only single-subgraph
+models are supported.
+
+The new Model table, its metadata and buffers vectors and the plan are
+prepended to the flatbuffer, which keeps every existing offset valid.
+"""
+
+import bisect
+import random
+import struct
+import sys
+
+from int8_io import FlatBuffer
+
+# Field indices from tensorflow/lite/schema/schema.fbs.
+MODEL_VERSION, MODEL_SUBGRAPHS, MODEL_BUFFERS, MODEL_METADATA = 0, 2, 4, 6
+MODEL_NUM_FIELDS = 8
+SUBGRAPH_TENSORS, SUBGRAPH_INPUTS, SUBGRAPH_OUTPUTS, SUBGRAPH_OPERATORS = (
+    0, 1, 2, 3)
+OPERATOR_INPUTS, OPERATOR_OUTPUTS = 1, 2
+TENSOR_SHAPE, TENSOR_TYPE, TENSOR_BUFFER, TENSOR_IS_VARIABLE = 0, 1, 2, 5
+BUFFER_DATA = 0
+METADATA_NAME, METADATA_BUFFER = 0, 1
+
+OFFLINE_METADATA = b'OfflineMemoryAllocation'
+ONLINE_PLANNED = -1
+ARENA_ALIGNMENT = 16
+
+# Bytes per element of each TensorType.
+TYPE_SIZES = {0: 4, 1: 2, 2: 4, 3: 1, 4: 8, 6: 1, 7: 2, 8: 8, 9: 1, 10: 8,
+              11: 16, 12: 8, 15: 4, 16: 2}
+
+SEARCH_STEPS = 2000
+
+
+class Buffer:
+
+    def __init__(self, tensor, size, first, last):
+        self.tensor = tensor
+        self.size = size
+        self.first = first
+        self.last = last
+
+    def overlaps(self, other):
+        return self.first <= other.last and other.first <= self.last
+
+
+def align_up(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def planned_buffers(fb):
+    """The tensors MicroAllocator plans, with their aligned sizes and
+    lifetimes, in tensor order."""
+    model = fb.root()
+    subgraphs = fb.tables(model, MODEL_SUBGRAPHS)
+    if len(subgraphs) != 1:
+        sys.exit('only single-subgraph models are supported')
+    subgraph = subgraphs[0]
+    tensors = fb.tables(subgraph, SUBGRAPH_TENSORS)
+    buffers = fb.tables(model, MODEL_BUFFERS)
+    operators = fb.tables(subgraph, SUBGRAPH_OPERATORS)
+
+    first = [-1] * len(tensors)
+    last = [-1] * len(tensors)
+    for tensor in fb.ints(subgraph, SUBGRAPH_INPUTS):
+        first[tensor] = last[tensor] = 0
+    for scope, op in enumerate(operators, 1):
+        for tensor in fb.ints(op, OPERATOR_OUTPUTS):
+            if first[tensor] == -1:
+                first[tensor] = scope
+        for tensor in fb.ints(op, OPERATOR_INPUTS):
+            if tensor >= 0:
+                last[tensor] = scope
+        for tensor in fb.ints(op, OPERATOR_OUTPUTS):
+            last[tensor] = scope
+    for tensor in fb.ints(subgraph, SUBGRAPH_OUTPUTS):
+        if first[tensor] == -1:
+            first[tensor] = len(operators)
+        last[tensor] = len(operators)
+
+    result = []
+    for i, tensor in enumerate(tensors):
+        buffer = buffers[fb.scalar(tensor, TENSOR_BUFFER, fb.u32)]
+        if fb.vector(buffer, BUFFER_DATA)[1]:
+            continue
+        if fb.scalar(tensor, TENSOR_IS_VARIABLE, fb.u8):
+            continue
+        tensor_type = fb.scalar(tensor, TENSOR_TYPE, fb.i8)
+        if tensor_type not in TYPE_SIZES:
+            sys.exit('tensor %d has unsupported type %d' % (i, tensor_type))
+        size = TYPE_SIZES[tensor_type]
+        for dim in fb.ints(tensor, TENSOR_SHAPE):
+            size *= dim
+        if size:
+            result.append(Buffer(i, align_up(size, ARENA_ALIGNMENT), first[i],
+                                 last[i]))
+    return result, len(tensors)
+
+
+def first_fit(buffers, order):
+    """Places buffers in the given order at the lowest offset that is free
+    for their lifetime, as GreedyMemoryPlanner does. Returns the offsets by
+    buffer index and the arena bytes used."""
+    offsets = [None] * len(buffers)
+    # (offset, index) of the placed buffers, in offset order.
+    placed = []
+    end = 0
+    for i in order:
+        wanted = buffers[i]
+        offset = 0
+        for placed_offset, j in placed:
+            if not buffers[j].overlaps(wanted):
+                continue
+            if placed_offset - offset >= wanted.size:
+                break
+            offset = max(offset, placed_offset + buffers[j].size)
+        offsets[i] = offset
+        bisect.insort(placed, (offset, i))
+        end = max(end, offset + wanted.size)
+    return offsets, end
+
+
+def greedy_order(buffers):
+    """GreedyMemoryPlanner's order: a stable sort by descending size of the
+    buffers in reverse, as it fills its sort array from the end."""
+    return sorted(reversed(range(len(buffers))), key=lambda i: -buffers[i].size)
+
+
+def lower_bound(buffers):
+    times = set(b.first for b in buffers)
+    return max([sum(b.size for b in buffers if b.first <= t <= b.last)
+                for t in times] or [0])
+
+
+def best_plan(buffers):
+    """Returns the smallest first-fit plan found: (offsets, bytes)."""
+    orders = [
+        greedy_order(buffers),
+        sorted(range(len(buffers)),
+               key=lambda i: (-buffers[i].size *
+                              (buffers[i].last - buffers[i].first + 1))),
+        sorted(range(len(buffers)),
+               key=lambda i: (buffers[i].first - buffers[i].last,
+                              -buffers[i].size)),
+        sorted(range(len(buffers)),
+               key=lambda i: (buffers[i].first, -buffers[i].size)),
+    ]
+    best_order = None
+    best = None
+    for order in orders:
+        plan = first_fit(buffers, order)
+        if best is None or plan[1] < best[1]:
+            best_order, best = order, plan
+
+    bound = lower_bound(buffers)
+    generator = random.Random(0)
+    order = list(best_order)
+    for _ in range(SEARCH_STEPS):
+        if best[1] == bound or len(order) < 2:
+            break
+        i, j = generator.sample(range(len(order)), 2)
+        order[i], order[j] = order[j], order[i]
+        plan = first_fit(buffers, order)
+        if plan[1] <= best[1]:
+            best = plan
+        else:
+            order[i], order[j] = order[j], order[i]
+    return best
+
+
+def report(path):
+    with open(path, 'rb') as f:
+        fb = FlatBuffer(bytearray(f.read()))
+    buffers, _ = planned_buffers(fb)
+    greedy = first_fit(buffers, greedy_order(buffers))[1]
+    offline = best_plan(buffers)[1]
+    print('%s: %d buffers, greedy %d bytes, offline %d bytes (%+d), lower '
+          'bound %d' % (path, len(buffers), greedy, offline, offline - greedy,
+                        lower_bound(buffers)))
+
+
+def string(fb, pos):
+    if pos is None:
+        return None
+    return bytes(fb.data[pos + 4:pos + 4 + fb.u32(pos)])
+
+
+class Writer:
+    """Builds the prepended part of the flatbuffer front to back. Offsets
+    to objects that are not yet written are patched once they are."""
+
+    def __init__(self):
+        self.data = bytearray()
+
+    def pad(self, alignment):
+        self.data += bytes(-len(self.data) % alignment)
+
+    def u16(self, value):
+        self.data += struct.pack('<H', value)
+
+    def u32(self, value):
+        pos = len(self.data)
+        self.data += struct.pack('<i' if value < 0 else '<I', value)
+        return pos
+
+    def patch(self, pos, target):
+        struct.pack_into('<I', self.data, pos, target - pos)
+
+
+def embed(fb, offsets, num_tensors):
+    """Returns the model bytes with the plan as OfflineMemoryAllocation
+    metadata."""
+    model = fb.root()
+    # An existing plan is replaced. Its buffer is left unused.
+    old_metadata = [m for m in fb.tables(model, MODEL_METADATA)
+                    if string(fb, fb.table(m, METADATA_NAME)) !=
+                    OFFLINE_METADATA]
+    old_buffers = fb.tables(model, MODEL_BUFFERS)
+    plan = [1, 0, num_tensors] + offsets
+
+    w = Writer()
+    root = w.u32(0)
+    w.data += fb.data[4:8]  # File identifier.
+
+    # The Model table keeps a 4-byte slot for every field, so the vtable maps
+    # field n to offset 4 + 4 * n, after the vtable offset.
+    vtable = len(w.data)
+    w.u16(4 + 2 * MODEL_NUM_FIELDS)
+    w.u16(4 + 4 * MODEL_NUM_FIELDS)
+    for index in range(MODEL_NUM_FIELDS):
+        present = index in (MODEL_VERSION, MODEL_BUFFERS, MODEL_METADATA) or (
+            fb.field(model, index) is not None)
+        w.u16(4 + 4 * index if present else 0)
+    w.pad(4)
+    table = len(w.data)
+    w.patch(root, table)
+    w.u32(table - vtable)
+    w.u32(fb.scalar(model, MODEL_VERSION, fb.u32))
+    fields = {}
+    for index in range(1, MODEL_NUM_FIELDS):
+        fields[index] = w.u32(0)
+
+    # Vectors of the new Model. Entries pointing into the old flatbuffer are
+    # patched once its position is known.
+    old_refs = []
+    w.patch(fields[MODEL_METADATA], len(w.data))
+    w.u32(len(old_metadata) + 1)
+    for metadata in old_metadata:
+        old_refs.append((w.u32(0), metadata))
+    new_metadata_ref = w.u32(0)
+    w.patch(fields[MODEL_BUFFERS], len(w.data))
+    w.u32(len(old_buffers) + 1)
+    for buffer in old_buffers:
+        old_refs.append((w.u32(0), buffer))
+    new_buffer_ref = w.u32(0)
+
+    # Metadata {name, buffer}.
+    vtable = len(w.data)
+    w.u16(8)
+    w.u16(12)
+    w.u16(4)
+    w.u16(8)
+    w.patch(new_metadata_ref, len(w.data))
+    w.u32(len(w.data) - vtable)
+    name_ref = w.u32(0)
+    w.u32(len(old_buffers))
+    w.patch(name_ref, len(w.data))
+    w.u32(len(OFFLINE_METADATA))
+    w.data += OFFLINE_METADATA + b'\0'
+    w.pad(4)
+
+    # Buffer {data}, with the plan 16-byte aligned.
+    vtable = len(w.data)
+    w.u16(6)
+    w.u16(8)
+    w.u16(4)
+    w.pad(4)
+    w.patch(new_buffer_ref, len(w.data))
+    w.u32(len(w.data) - vtable)
+    data_ref = w.u32(0)
+    while len(w.data) % ARENA_ALIGNMENT != ARENA_ALIGNMENT - 4:
+        w.data += bytes(1)
+    w.patch(data_ref, len(w.data))
+    w.u32(4 * len(plan))
+    for value in plan:
+        w.u32(value)
+    w.pad(ARENA_ALIGNMENT)
+
+    # The old flatbuffer follows, shifted by a multiple of its alignment.
+    base = len(w.data)
+    for index in range(1, MODEL_NUM_FIELDS):
+        if index in (MODEL_BUFFERS, MODEL_METADATA):
+            continue
+        pos = fb.field(model, index)
+        if pos is not None:
+            w.patch(fields[index], base + fb.deref(pos))
+    for pos, target in old_refs:
+        w.patch(pos, base + target)
+    return w.data + fb.data
+
+
+def main(argv):
+    if len(argv) >= 3 and argv[1] == 'report':
+        for path in argv[2:]:
+            report(path)
+    elif len(argv) == 4 and argv[1] == 'embed':
+        with open(argv[2], 'rb') as f:
+            fb = FlatBuffer(bytearray(f.read()))
+        buffers, num_tensors = planned_buffers(fb)
+        plan, size = best_plan(buffers)
+        greedy = first_fit(buffers, greedy_order(buffers))[1]
+        offsets = [ONLINE_PLANNED] * num_tensors
+        for buffer, offset in zip(buffers, plan):
+            offsets[buffer.tensor] = offset
+        with open(argv[3], 'wb') as f:
+            f.write(embed(fb, offsets, num_tensors))
+        print('%d buffers, greedy %d bytes, offline %d bytes (%+d)' %
+              (len(buffers), greedy, size, size - greedy))
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == '__main__':
+    main(sys.argv)
@@ -0,0 +1,73 @@
+#!/bin/env python
+# Copyright 2023 The CFU-Playground Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Packs .tflite models into an image for SPI flash (MODELS_IN_SPIFLASH).
+
+  xip_image.py OUT.bin MODEL.tflite...
+
+Each model is named after its file without extension, as the arrays made by
+xxd.py are, so src/models/ds_cnn_stream_fe/ds_cnn_stream_fe_int8.tflite is
+found by xip_find_model("ds_cnn_stream_fe_int8"). The layout is described in
+src/xip_models.h.
+
+Program OUT.bin into the flash at XIP_IMAGE_OFFSET (8 MiB unless the
+Makefile defines it) with the board's flash programmer, clear of the
+bitstream, and rebuild with MODELS_IN_SPIFLASH.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b'XIPM'
+NAME_BYTES = 24
+ENTRY = struct.Struct('<%dsIII' % NAME_BYTES)
+MODEL_ALIGNMENT = 16
+
+
+def align_up(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def main(argv):
+    if len(argv) < 3:
+        sys.exit(__doc__)
+
+    models = []
+    for path in argv[2:]:
+        name = os.path.splitext(os.path.basename(path))[0].encode()
+        if len(name) >= NAME_BYTES:
+            sys.exit('%s: name longer than %d bytes' % (path, NAME_BYTES - 1))
+        with open(path, 'rb') as f:
+            models.append((name, f.read()))
+
+    image = bytearray(MAGIC + struct.pack('<I', len(models)))
+    offset = align_up(len(image) + ENTRY.size * len(models), MODEL_ALIGNMENT)
+    for name, data in models:
+        image += ENTRY.pack(name, offset, len(data),
+                            zlib.crc32(data) & 0xffffffff)
+        offset = align_up(offset + len(data), MODEL_ALIGNMENT)
+    for name, data in models:
+        image += bytes(align_up(len(image), MODEL_ALIGNMENT) - len(image))
+        image += data
+        print('%s: %d bytes' % (name.decode(), len(data)))
+
+    with open(argv[1], 'wb') as f:
+        f.write(image)
+    print('%s: %d bytes' % (argv[1], len(image)))
+
+
+if __name__ == '__main__':
+    main(sys.argv)
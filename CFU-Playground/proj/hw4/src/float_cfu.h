@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _FLOAT_CFU_H
+#define _FLOAT_CFU_H
+
+#include <stdint.h>
+
+#include "cfu.h"
+
+// Single-precision float unit on funct3 1 of the CFU (see cfu.v). Every
+// result is rounded once to nearest even, subnormals are flushed to zero.
+// The kernels use it in place of soft-float when FLOAT_CFU is defined.
+
+#define FLOAT_CFU_MUL 0
+#define FLOAT_CFU_ADD 1
+#define FLOAT_CFU_MAC 2
+#define FLOAT_CFU_SET_ACC 3
+
+union FloatCfuWord {
+  float f;
+  uint32_t u;
+};
+
+inline uint32_t float_cfu_bits(float x) {
+  FloatCfuWord w;
+  w.f = x;
+  return w.u;
+}
+
+inline float float_cfu_float(uint32_t x) {
+  FloatCfuWord w;
+  w.u = x;
+  return w.f;
+}
+
+inline float float_cfu_mul(float a, float b) {
+  return float_cfu_float(
+      cfu_op1(FLOAT_CFU_MUL, float_cfu_bits(a), float_cfu_bits(b)));
+}
+
+inline float float_cfu_add(float a, float b) {
+  return float_cfu_float(
+      cfu_op1(FLOAT_CFU_ADD, float_cfu_bits(a), float_cfu_bits(b)));
+}
+
+// Loads the accumulator.
+inline void float_cfu_set_acc(float x) {
+  cfu_op1(FLOAT_CFU_SET_ACC, float_cfu_bits(x), 0);
+}
+
+// acc = acc + a * b, fused, and returns the new accumulator.
+inline float float_cfu_mac(float a, float b) {
+  return float_cfu_float(
+      cfu_op1(FLOAT_CFU_MAC, float_cfu_bits(a), float_cfu_bits(b)));
+}
+
+// a * b + c * d.
+inline float float_cfu_dot2(float a, float b, float c, float d) {
+  float_cfu_set_acc(0.0f);
+  float_cfu_mac(a, b);
+  return float_cfu_mac(c, d);
+}
+
+#endif  // _FLOAT_CFU_H
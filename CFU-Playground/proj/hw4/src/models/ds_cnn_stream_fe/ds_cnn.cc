@@ -0,0 +1,308 @@
+#include "models/ds_cnn_stream_fe/ds_cnn.h"
+#include <stdio.h>
+#include <string.h>
+#include "menu.h"
+#ifndef MODELS_IN_SPIFLASH
+#include "models/ds_cnn_stream_fe/ds_cnn_stream_fe.h"
+#ifdef DS_CNN_INT8_IO
+#include "models/ds_cnn_stream_fe/ds_cnn_stream_fe_int8.h"
+#endif
+#endif
+#ifdef DS_CNN_INT8_IO
+#include "models/label/label0_int8.h"
+#include "models/label/label11_int8.h"
+#include "models/label/label1_int8.h"
+#include "models/label/label6_int8.h"
+#include "models/label/label8_int8.h"
+#endif
+#include "models/label/label0_board.h"
+#include "models/label/label11_board.h"
+#include "models/label/label1_board.h"
+#include "models/label/label6_board.h"
+#include "models/label/label8_board.h"
+#include "perf.h"
+#include "tensorflow/lite/kernels/internal/mfcc.h"
+#include "tensorflow/lite/kernels/internal/spectrogram.h"
+#include "tflite.h"
+#include "xip_models.h"
+
+// Keeps a model resident next to the other variant, so switching between
+// the float and int8 models costs no setup, and selects it.
+static int use_model(const unsigned char* model_data,
+                     unsigned int model_length) {
+    const int model = tflite_add_model(model_data, model_length);
+    tflite_select_model(model);
+    return model;
+}
+
+#ifdef MODELS_IN_SPIFLASH
+// Same as use_model, for a model read in place from the SPI flash image
+// written by scripts/xip_image.py.
+static int use_flash_model(const char* name) {
+    unsigned int model_length = 0;
+    const unsigned char* model_data = xip_find_model(name, &model_length);
+    return model_data ? use_model(model_data, model_length) : -1;
+}
+#endif
+
+// Initialize everything once
+static int ds_cnn_stream_fe_init(void) {
+#ifdef MODELS_IN_SPIFLASH
+    return use_flash_model("ds_cnn_stream_fe");
+#else
+    return use_model(ds_cnn_stream_fe, ds_cnn_stream_fe_len);
+#endif
+}
+
+// Implement your design here
+static void do_predict_fp_label(int model, const float* label_data) {
+    // set input: read the clip in place, saving a copy per inference
+    size_t input_bytes;
+    tflite_input_buffer(&input_bytes);
+    if (!tflite_bind_input(label_data, input_bytes)) {
+        tflite_set_input_float(label_data);
+    }
+
+    // start classification
+    tflite_classify(model);
+
+    // get output
+    uint32_t output32[12];
+    memcpy(output32, tflite_get_output_float(), 12 * sizeof(float));
+    // memcpy(output32, tflite_get_output(), 12 * sizeof(int8_t));
+
+    // print output
+    // printf("    Results are: \n");
+    for (int i = 0; i < 12; i++) {
+        printf("%d : 0x%08lx, \n", i, output32[i]);
+    }
+}
+
+// Front end parameters, taken from the AudioSpectrogram and Mfcc custom
+// options in ds_cnn_stream_fe.tflite.
+#define FE_WINDOW_SIZE 640
+#define FE_STRIDE 320
+#define FE_FFT_LENGTH 1024
+#define FE_SPECTROGRAM_CHANNELS 513
+#define FE_FRAMES 49
+#define FE_DCT_COEFFICIENTS 20
+
+// Quantization of the QUANTIZE op that consumes the Mfcc output.
+#define FE_MFCC_SCALE 1.07679f
+#define FE_MFCC_ZERO_POINT 102
+
+template <class Real>
+struct FrontEnd {
+    tflite::internal::Spectrogram<Real> spectrogram;
+    tflite::internal::Mfcc<Real> mfcc;
+
+    void init() {
+        // One window per call, so frames can be computed one at a time.
+        spectrogram.Initialize(FE_WINDOW_SIZE, FE_STRIDE, FE_WINDOW_SIZE,
+                               FE_FFT_LENGTH, FE_SPECTROGRAM_CHANNELS);
+        mfcc.set_upper_frequency_limit(7600);
+        mfcc.set_lower_frequency_limit(20);
+        mfcc.set_filterbank_channel_count(40);
+        mfcc.set_dct_coefficient_count(FE_DCT_COEFFICIENTS);
+        mfcc.Initialize(FE_SPECTROGRAM_CHANNELS, 16000);
+    }
+
+    // Returns the cycles spent computing one frame.
+    unsigned compute(const float* window, float* spectrum, float* output) {
+        unsigned start = perf_get_mcycle();
+        spectrogram.ComputeSquaredMagnitudeSpectrogram(window, spectrum);
+        mfcc.Compute(spectrum, FE_SPECTROGRAM_CHANNELS, output);
+        return perf_get_mcycle() - start;
+    }
+};
+
+static FrontEnd<double> fe_double;
+static FrontEnd<float> fe_float;
+
+static int quantize_mfcc(float value) {
+    float scaled = value / FE_MFCC_SCALE;
+    int q = static_cast<int>(scaled < 0 ? scaled - 0.5f : scaled + 0.5f) +
+            FE_MFCC_ZERO_POINT;
+    return q < -128 ? -128 : (q > 127 ? 127 : q);
+}
+
+// Runs the double and float front ends on one clip and prints the largest
+// MFCC difference (in millionths), the number of features that quantize to a
+// different int8 value, and the cycles taken by each precision.
+static void compare_front_end(const char* name, const float* label_data) {
+    static float spectrum[FE_SPECTROGRAM_CHANNELS];
+    float mfcc_double[FE_DCT_COEFFICIENTS];
+    float mfcc_float[FE_DCT_COEFFICIENTS];
+    float max_error = 0;
+    int mismatches = 0;
+    uint64_t double_cycles = 0;
+    uint64_t float_cycles = 0;
+
+    for (int frame = 0; frame < FE_FRAMES; frame++) {
+        const float* window = label_data + frame * FE_STRIDE;
+        double_cycles += fe_double.compute(window, spectrum, mfcc_double);
+        float_cycles += fe_float.compute(window, spectrum, mfcc_float);
+        for (int i = 0; i < FE_DCT_COEFFICIENTS; i++) {
+            float error = mfcc_double[i] - mfcc_float[i];
+            if (error < 0) error = -error;
+            if (error > max_error) max_error = error;
+            if (quantize_mfcc(mfcc_double[i]) != quantize_mfcc(mfcc_float[i])) {
+                mismatches++;
+            }
+        }
+    }
+
+    printf("%-8s max |err| %6ld e-6, int8 mismatches %3d/%d, cycles double ",
+           name, static_cast<long>(max_error * 1000000.0f), mismatches,
+           FE_FRAMES * FE_DCT_COEFFICIENTS);
+    perf_print_human(double_cycles);
+    printf(" float ");
+    perf_print_human(float_cycles);
+    printf("\n");
+}
+
+static void do_compare_front_end_precision() {
+    fe_double.init();
+    fe_float.init();
+    puts("Float vs double audio front end on the label clips");
+    compare_front_end("Label0", label0_data);
+    compare_front_end("Label1", label1_data);
+    compare_front_end("Label6", label6_data);
+    compare_front_end("Label8", label8_data);
+    compare_front_end("Label11", label11_data);
+}
+
+static void do_predict_all_labels() {
+    const int model = ds_cnn_stream_fe_init();
+    if (model < 0) {
+        return;
+    }
+
+    // printf("Label0: \n");
+    // do_predict_fp_label(model, label0_data);
+
+    // printf("Label1: \n");
+    // do_predict_fp_label(model, label1_data);
+
+    // printf("Label6: \n");
+    // do_predict_fp_label(model, label6_data);
+
+    do_predict_fp_label(model, label8_data);
+    printf("---- Label8. \n");
+
+    // printf("Label11: \n");
+    // do_predict_fp_label(model, label11_data);
+}
+
+// Runs the label clips back to back and prints the best class of each.
+static void do_predict_all_labels_batch() {
+    const int model = ds_cnn_stream_fe_init();
+    if (model < 0) {
+        return;
+    }
+
+    const char* names[] = {"Label0", "Label1", "Label6", "Label8", "Label11"};
+    const void* inputs[] = {label0_data, label1_data, label6_data, label8_data,
+                            label11_data};
+    float scores[5][12];
+    void* outputs[] = {scores[0], scores[1], scores[2], scores[3], scores[4]};
+    tflite_classify_batch(inputs, 5, outputs);
+
+    for (int i = 0; i < 5; i++) {
+        int best = 0;
+        for (int c = 1; c < 12; c++) {
+            if (scores[i][c] > scores[i][best]) {
+                best = c;
+            }
+        }
+        printf("%s: class %d\n", names[i], best);
+    }
+}
+
+// Runs Label0 a few operators at a time, as a main loop that services I/O
+// between steps would, and prints the longest step.
+static void do_predict_label0_in_steps() {
+    const int model = ds_cnn_stream_fe_init();
+    if (model < 0) {
+        return;
+    }
+
+    tflite_set_input_float(label0_data);
+    int steps = 0;
+    int remaining;
+    do {
+        remaining = tflite_classify_step(4);
+        steps++;
+    } while (remaining > 0);
+    if (remaining < 0) {
+        return;
+    }
+
+    printf("%d steps of up to 4 ops, longest ", steps);
+    perf_print_value(tflite_max_step_cycles());
+    printf(" cycles\n");
+    uint32_t output32[12];
+    memcpy(output32, tflite_get_output_float(), 12 * sizeof(float));
+    for (int i = 0; i < 12; i++) {
+        printf("%d : 0x%08lx, \n", i, output32[i]);
+    }
+}
+
+#ifdef DS_CNN_INT8_IO
+// Same as do_predict_fp_label, on the model whose boundary QUANTIZE and
+// DEQUANTIZE ops were stripped by scripts/int8_io.py. The clip goes in as
+// int8 (s=0.00784302, z=0) and the scores come out as int8 (s=0.252685, z=32).
+static void do_predict_int8_label(int model, const unsigned char* label_data) {
+    tflite_set_input(label_data);
+
+    tflite_classify(model);
+
+    const int8_t* output = tflite_get_output();
+    for (int i = 0; i < 12; i++) {
+        printf("%d : %4d, \n", i, output[i]);
+    }
+}
+
+static void do_predict_all_int8_labels() {
+#ifdef MODELS_IN_SPIFLASH
+    const int model = use_flash_model("ds_cnn_stream_fe_int8");
+#else
+    const int model = use_model(ds_cnn_stream_fe_int8, ds_cnn_stream_fe_int8_len);
+#endif
+    if (model < 0) {
+        return;
+    }
+
+    do_predict_int8_label(model, label0_int8);
+    printf("---- Label0. \n");
+    do_predict_int8_label(model, label1_int8);
+    printf("---- Label1. \n");
+    do_predict_int8_label(model, label6_int8);
+    printf("---- Label6. \n");
+    do_predict_int8_label(model, label8_int8);
+    printf("---- Label8. \n");
+    do_predict_int8_label(model, label11_int8);
+    printf("---- Label11. \n");
+}
+#endif
+
+static struct Menu MENU = {
+    "Tests for ds_cnn_stream_fe",
+    "ds_cnn_stream_fe",
+    {
+        MENU_ITEM('1', "Predict all label data", do_predict_all_labels),
+        MENU_ITEM('2', "Compare float vs double front end", do_compare_front_end_precision),
+#ifdef DS_CNN_INT8_IO
+        MENU_ITEM('3', "Predict all label data (int8 in/out)", do_predict_all_int8_labels),
+#endif
+        MENU_ITEM('4', "Predict all label data as a batch", do_predict_all_labels_batch),
+        MENU_ITEM('5', "Predict label0 in steps of 4 ops", do_predict_label0_in_steps),
+        MENU_END,
+    },
+};
+
+// For integration into menu system
+void ds_cnn_stream_fe_menu() {
+    ds_cnn_stream_fe_init();
+    menu_run(&MENU);
+}
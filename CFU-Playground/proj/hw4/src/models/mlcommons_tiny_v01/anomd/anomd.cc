@@ -0,0 +1,261 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "models/mlcommons_tiny_v01/anomd/anomd.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "menu.h"
+#include "models/mlcommons_tiny_v01/anomd/test_data/quant_anomaly_0.h"
+#include "models/mlcommons_tiny_v01/anomd/test_data/quant_anomaly_1.h"
+#include "models/mlcommons_tiny_v01/anomd/test_data/quant_anomaly_2.h"
+#include "models/mlcommons_tiny_v01/anomd/test_data/quant_normal_0.h"
+#include "models/mlcommons_tiny_v01/anomd/test_data/quant_normal_1.h"
+#include "models/mlcommons_tiny_v01/anomd/test_data/quant_normal_2.h"
+#include "perf.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tflite.h"
+#include "tiny/v0.1/training/anomaly_detection/trained_models/ad01_int8.h"
+
+#define NUM_GOLDEN 6
+
+struct {
+  const unsigned char* data;
+  uint32_t actual;
+} mlcommons_tiny_v01_ad_dataset[NUM_GOLDEN] = {
+    {quant_anomaly_0, 0x2268a03d}, {quant_anomaly_1, 0xefeefb35},
+    {quant_anomaly_2, 0x8c908c27}, {quant_normal_0, 0xd02be5d},
+    {quant_normal_1, 0x2bc9ce4a},  {quant_normal_2, 0xe7251f32},
+};
+
+static void anomd_init(void) {
+  tflite_load_model(ad01_int8, ad01_int8_len);
+}
+
+// 32 bit xor reduction used because comparing 640 outputs is unwieldy.
+uint32_t uint32_xor_reduction(int8_t* output, unsigned int length) {
+  uint32_t x = 0;
+  int8_t j = 0;
+  for (size_t i = 0; i < length; i++) {
+    x ^= output[i] << ((j++ & 0x3) << 3);
+  }
+  return x;
+}
+
+uint32_t anomd_classify() {
+  printf("Running anomd\n");
+  tflite_classify();
+
+  int8_t* output = tflite_get_output();
+  return uint32_xor_reduction(output, 640);
+}
+
+#define MLCOMMONS_TINY_V01_ANOMALY_DETECTION_TEST(name, test_index)   \
+  static void name() {                                                \
+    puts(#name);                                                      \
+    tflite_set_input(mlcommons_tiny_v01_ad_dataset[test_index].data); \
+    printf("  result-- 32 bit xor: 0x%lx\n", anomd_classify());       \
+  }
+
+// Smattering of tests for the menu, more can be easily added/removed.
+
+MLCOMMONS_TINY_V01_ANOMALY_DETECTION_TEST(do_classify_anomaly_0, 0);
+MLCOMMONS_TINY_V01_ANOMALY_DETECTION_TEST(do_classify_anomaly_1, 1);
+MLCOMMONS_TINY_V01_ANOMALY_DETECTION_TEST(do_classify_normal_0, 3);
+MLCOMMONS_TINY_V01_ANOMALY_DETECTION_TEST(do_classify_normal_1, 4);
+
+#undef MLCOMMONS_TINY_V01_ANOMALY_DETECTION_TEST
+
+static void do_golden_tests() {
+  bool failed = false;
+  for (size_t i = 0; i < NUM_GOLDEN; i++) {
+    tflite_set_input(mlcommons_tiny_v01_ad_dataset[i].data);
+    uint32_t res = anomd_classify();
+    uint32_t exp = mlcommons_tiny_v01_ad_dataset[i].actual;
+    if (res != exp) {
+      failed = true;
+      printf("*** Golden test %d failed: \n", i);
+      printf("actual: 32 bit xor: 0x%lx\n", res);
+      printf("expected: 32 bit xor: 0x%lx\n", exp);
+    }
+  }
+
+  if (failed) {
+    puts("FAIL Golden tests failed");
+  } else {
+    puts("OK   Golden tests passed");
+  }
+}
+
+// Batched FC on the model's first dense layer, with 1 to 8 batch rows taken
+// from consecutive input frames of normal clip 0. Times one weight-stationary
+// call (FullyConnectedBlockedBatches) against one call per batch row, and
+// checks that both give the same outputs. The weights are copied out of the
+// model because the kernel needs them word aligned.
+constexpr int kFcBenchMaxDepth = 640;
+constexpr int kFcBenchMaxOutputs = 128;
+constexpr int kFcBenchMaxBatches = 8;
+static int32_t fc_bench_input[kFcBenchMaxBatches * kFcBenchMaxDepth / 4];
+static int32_t fc_bench_filter[kFcBenchMaxOutputs * kFcBenchMaxDepth / 4];
+static int32_t fc_bench_bias[kFcBenchMaxOutputs];
+static int32_t fc_bench_multiplier[kFcBenchMaxOutputs];
+static int fc_bench_shift[kFcBenchMaxOutputs];
+static int8_t fc_bench_row_output[kFcBenchMaxBatches * kFcBenchMaxOutputs];
+static int8_t fc_bench_batch_output[kFcBenchMaxBatches * kFcBenchMaxOutputs];
+
+// The first FULLY_CONNECTED operator of the model, or nullptr.
+static const tflite::Operator* first_fully_connected(
+    const tflite::Model* model) {
+  for (const tflite::Operator* op : *model->subgraphs()->Get(0)->operators()) {
+    const tflite::OperatorCode* code =
+        model->operator_codes()->Get(op->opcode_index());
+    if (tflite::GetBuiltinCode(code) ==
+        tflite::BuiltinOperator_FULLY_CONNECTED) {
+      return op;
+    }
+  }
+  return nullptr;
+}
+
+static void do_fc_batch_benchmark() {
+  const tflite::Model* model = tflite::GetModel(ad01_int8);
+  const tflite::Operator* op = first_fully_connected(model);
+  if (op == nullptr) {
+    puts("No FULLY_CONNECTED op in the model");
+    return;
+  }
+  const auto* tensors = model->subgraphs()->Get(0)->tensors();
+  const tflite::Tensor* input = tensors->Get(op->inputs()->Get(0));
+  const tflite::Tensor* filter = tensors->Get(op->inputs()->Get(1));
+  const tflite::Tensor* output = tensors->Get(op->outputs()->Get(0));
+  const int output_depth = filter->shape()->Get(0);
+  const int accum_depth = filter->shape()->Get(1);
+  if (input->type() != tflite::TensorType_INT8 ||
+      filter->type() != tflite::TensorType_INT8 ||
+      output_depth > kFcBenchMaxOutputs || accum_depth > kFcBenchMaxDepth ||
+      accum_depth % 4 != 0) {
+    puts("The first FULLY_CONNECTED op does not fit the benchmark");
+    return;
+  }
+
+  const int8_t* filter_data = reinterpret_cast<const int8_t*>(
+      model->buffers()->Get(filter->buffer())->data()->data());
+  memcpy(fc_bench_filter, filter_data, output_depth * accum_depth);
+  const int32_t* bias_data = nullptr;
+  if (op->inputs()->size() > 2 && op->inputs()->Get(2) >= 0) {
+    const tflite::Tensor* bias = tensors->Get(op->inputs()->Get(2));
+    bias_data = reinterpret_cast<const int32_t*>(
+        model->buffers()->Get(bias->buffer())->data()->data());
+  }
+  const int32_t input_zero_point = input->quantization()->zero_point()->Get(0);
+  tflite::reference_integer_ops::FullyConnectedFoldBias(
+      -input_zero_point, reinterpret_cast<const int8_t*>(fc_bench_filter),
+      bias_data, output_depth, accum_depth, fc_bench_bias);
+
+  const float input_scale = input->quantization()->scale()->Get(0);
+  const float output_scale = output->quantization()->scale()->Get(0);
+  const auto* filter_scales = filter->quantization()->scale();
+  const bool per_channel = filter_scales->size() > 1;
+  // Rounded as in the FULLY_CONNECTED kernel's Prepare.
+  for (uint32_t c = 0; c < filter_scales->size(); c++) {
+    const float filter_scale = filter_scales->Get(c);
+    const double scale =
+        per_channel ? static_cast<double>(input_scale) *
+                          static_cast<double>(filter_scale) /
+                          static_cast<double>(output_scale)
+                    : static_cast<double>(input_scale * filter_scale) /
+                          static_cast<double>(output_scale);
+    tflite::QuantizeMultiplier(scale, &fc_bench_multiplier[c],
+                               &fc_bench_shift[c]);
+  }
+
+  tflite::FullyConnectedParams params = {};
+  params.output_offset = output->quantization()->zero_point()->Get(0);
+  params.quantized_activation_min = -128;
+  params.quantized_activation_max = 127;
+  const tflite::FullyConnectedOptions* options =
+      op->builtin_options_as_FullyConnectedOptions();
+  if (options != nullptr && options->fused_activation_function() ==
+                                tflite::ActivationFunctionType_RELU) {
+    params.quantized_activation_min = params.output_offset;
+  }
+
+  int8_t* batch_input = reinterpret_cast<int8_t*>(fc_bench_input);
+  memcpy(batch_input, quant_normal_0, kFcBenchMaxBatches * accum_depth);
+  const int8_t* filter_copy = reinterpret_cast<int8_t*>(fc_bench_filter);
+  const int32_t filter_dims[] = {output_depth, accum_depth};
+  const tflite::RuntimeShape filter_shape(2, filter_dims);
+  const int32_t row_input_dims[] = {1, accum_depth};
+  const int32_t row_output_dims[] = {1, output_depth};
+  const tflite::RuntimeShape row_input_shape(2, row_input_dims);
+  const tflite::RuntimeShape row_output_shape(2, row_output_dims);
+
+  printf("FC %dx%d, %s quantization\n", accum_depth, output_depth,
+         per_channel ? "per-channel" : "per-tensor");
+  printf("\"Batches\",\"Per-row cycles\",\"Batched cycles\"\n");
+  for (int batches = 1; batches <= kFcBenchMaxBatches; batches++) {
+    unsigned start = perf_get_mcycle();
+    for (int b = 0; b < batches; b++) {
+      tflite::reference_integer_ops::FullyConnectedBlocked(
+          params, fc_bench_bias, fc_bench_multiplier, fc_bench_shift,
+          per_channel, row_input_shape, batch_input + b * accum_depth,
+          filter_shape, filter_copy, row_output_shape,
+          fc_bench_row_output + b * output_depth);
+    }
+    unsigned per_row = perf_get_mcycle() - start;
+
+    const int32_t input_dims[] = {batches, accum_depth};
+    const int32_t output_dims[] = {batches, output_depth};
+    start = perf_get_mcycle();
+    tflite::reference_integer_ops::FullyConnectedBlocked(
+        params, fc_bench_bias, fc_bench_multiplier, fc_bench_shift,
+        per_channel, tflite::RuntimeShape(2, input_dims), batch_input,
+        filter_shape, filter_copy, tflite::RuntimeShape(2, output_dims),
+        fc_bench_batch_output);
+    unsigned batched = perf_get_mcycle() - start;
+    printf("%d,%u,%u\n", batches, per_row, batched);
+    if (memcmp(fc_bench_row_output, fc_bench_batch_output,
+               batches * output_depth) != 0) {
+      printf("*** Batched outputs differ for %d batches\n", batches);
+    }
+  }
+}
+
+static struct Menu MENU = {
+    "Tests for anomd model",
+    "anomd",
+    {
+        MENU_ITEM('0', "Run with anomaly 0", do_classify_anomaly_0),
+        MENU_ITEM('1', "Run with normal 0", do_classify_normal_0),
+        MENU_ITEM('2', "Run with anomaly 1", do_classify_anomaly_1),
+        MENU_ITEM('3', "Run with normal 1", do_classify_normal_1),
+        MENU_ITEM('b', "FC batch 1..8 benchmark (first dense layer)",
+                  do_fc_batch_benchmark),
+        MENU_ITEM('g', "Run golden tests (check for expected outputs)",
+                  do_golden_tests),
+        MENU_END,
+    },
+};
+
+// For integration into menu system
+void mlcommons_tiny_v01_anomd_menu() {
+  anomd_init();
+  menu_run(&MENU);
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "op_profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "perf.h"
+#include "phase_timer.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+
+bool op_profile_enabled = false;
+bool op_profile_counters_enabled = false;
+
+namespace {
+
+typedef flatbuffers::Vector<flatbuffers::Offset<tflite::Tensor>> Tensors;
+typedef flatbuffers::Vector<int32_t> TensorIndices;
+
+struct OpRecord {
+  const char* tag;
+  uint64_t cycles;
+#if NUM_PERF_COUNTERS > 0
+  // Counter values at op_profile_begin() until op_profile_end(), then the
+  // deltas.
+  uint32_t counters[NUM_PERF_COUNTERS];
+#endif
+};
+
+constexpr int kMaxOpRecords = 256;
+OpRecord records[kMaxOpRecords];
+int num_records;
+
+// Ops begun and not yet ended. Only ops at depth 0 are recorded.
+int depth;
+uint64_t start_cycles;
+
+const tflite::Model* profiled_model;
+
+const tflite::Tensor* get_tensor(const Tensors* tensors,
+                                 const TensorIndices* indices, int i) {
+  if (indices == nullptr || i >= static_cast<int>(indices->size())) {
+    return nullptr;
+  }
+  const int index = indices->Get(i);
+  return index < 0 ? nullptr : tensors->Get(index);
+}
+
+int64_t dim(const tflite::Tensor* tensor, int i) {
+  if (tensor == nullptr || tensor->shape() == nullptr ||
+      i >= static_cast<int>(tensor->shape()->size())) {
+    return 0;
+  }
+  return tensor->shape()->Get(i);
+}
+
+int64_t flat_size(const tflite::Tensor* tensor) {
+  if (tensor == nullptr || tensor->shape() == nullptr) return 0;
+  int64_t size = 1;
+  for (int32_t d : *tensor->shape()) size *= d;
+  return size;
+}
+
+// Multiply-accumulates done by the op; zero for ops that are not built on
+// dot products.
+int64_t op_macs(const Tensors* tensors, const tflite::Operator* op,
+                tflite::BuiltinOperator code) {
+  const TensorIndices* inputs = op->inputs();
+  const tflite::Tensor* output = get_tensor(tensors, op->outputs(), 0);
+  switch (code) {
+    case tflite::BuiltinOperator_CONV_2D: {
+      const tflite::Tensor* filter = get_tensor(tensors, inputs, 1);
+      return flat_size(output) * dim(filter, 1) * dim(filter, 2) *
+             dim(filter, 3);
+    }
+    case tflite::BuiltinOperator_DEPTHWISE_CONV_2D: {
+      const tflite::Tensor* filter = get_tensor(tensors, inputs, 1);
+      return flat_size(output) * dim(filter, 1) * dim(filter, 2);
+    }
+    case tflite::BuiltinOperator_FULLY_CONNECTED:
+      return flat_size(output) * dim(get_tensor(tensors, inputs, 1), 1);
+    case tflite::BuiltinOperator_TRANSPOSE_CONV: {
+      const tflite::Tensor* filter = get_tensor(tensors, inputs, 1);
+      return flat_size(get_tensor(tensors, inputs, 2)) * dim(filter, 0) *
+             dim(filter, 1) * dim(filter, 2);
+    }
+    case tflite::BuiltinOperator_SVDF: {
+      const tflite::Tensor* input = get_tensor(tensors, inputs, 0);
+      const tflite::Tensor* weights_time = get_tensor(tensors, inputs, 2);
+      return dim(input, 0) * dim(weights_time, 0) *
+             (dim(input, 1) + dim(weights_time, 1));
+    }
+    default:
+      return 0;
+  }
+}
+
+// Prints the shapes of the tensors as a quoted CSV field, such as
+// "1x49x10x1 64x10x4x1 64". Omitted optional tensors are printed as "-".
+void print_shapes(const Tensors* tensors, const TensorIndices* indices) {
+  printf("\"");
+  for (int i = 0; indices != nullptr && i < static_cast<int>(indices->size());
+       i++) {
+    if (i) printf(" ");
+    const tflite::Tensor* tensor = get_tensor(tensors, indices, i);
+    if (tensor == nullptr || tensor->shape() == nullptr) {
+      printf("-");
+      continue;
+    }
+    if (tensor->shape()->size() == 0) {
+      printf("scalar");
+      continue;
+    }
+    for (int d = 0; d < static_cast<int>(tensor->shape()->size()); d++) {
+      printf(d ? "x%ld" : "%ld", static_cast<long>(tensor->shape()->Get(d)));
+    }
+  }
+  printf("\"");
+}
+
+void print_percent(uint64_t part, uint64_t total) {
+  const uint64_t tenths = total ? part * 1000 / total : 0;
+  printf("%lu.%lu", static_cast<unsigned long>(tenths / 10),
+         static_cast<unsigned long>(tenths % 10));
+}
+
+}  // anonymous namespace
+
+int64_t op_profile_macs(const tflite::Model* model, const tflite::Operator* op) {
+  return op_macs(model->subgraphs()->Get(0)->tensors(), op,
+                 tflite::GetBuiltinCode(
+                     model->operator_codes()->Get(op->opcode_index())));
+}
+
+void op_profile_set_model(const tflite::Model* model) {
+  profiled_model = model;
+  op_profile_reset();
+}
+
+void op_profile_reset(void) {
+  num_records = 0;
+  depth = 0;
+#ifdef PHASE_TIMERS
+  phase_timer_reset();
+#endif
+}
+
+void op_profile_start_counters(void) {
+  for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+    perf_enable_counter(i);
+  }
+}
+
+void op_profile_begin(const char* tag) {
+  if (depth++ != 0 || num_records == kMaxOpRecords) return;
+  OpRecord& record = records[num_records];
+  record.tag = tag;
+#if NUM_PERF_COUNTERS > 0
+  if (op_profile_counters_enabled) {
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+      record.counters[i] = perf_get_counter(i);
+    }
+  }
+#endif
+  start_cycles = perf_get_mcycle64();
+}
+
+void op_profile_end(void) {
+  const uint64_t end_cycles = perf_get_mcycle64();
+  if (--depth != 0 || num_records == kMaxOpRecords) return;
+  OpRecord& record = records[num_records++];
+  record.cycles = end_cycles - start_cycles;
+#if NUM_PERF_COUNTERS > 0
+  if (op_profile_counters_enabled) {
+    for (int i = 0; i < NUM_PERF_COUNTERS; i++) {
+      record.counters[i] = perf_get_counter(i) - record.counters[i];
+    }
+  }
+#endif
+}
+
+int op_profile_current_op(void) {
+  return depth > 0 && num_records < kMaxOpRecords ? num_records : -1;
+}
+
+const char* op_profile_tag(int op) { return records[op].tag; }
+
+void op_profile_print(void) {
+  const tflite::SubGraph* subgraph =
+      profiled_model ? profiled_model->subgraphs()->Get(0) : nullptr;
+  const int num_nodes =
+      subgraph && subgraph->operators() ? subgraph->operators()->size() : 0;
+
+  // Totals per op type, in order of first appearance.
+  struct TypeTotal {
+    const char* tag;
+    uint32_t count;
+    uint64_t macs;
+    uint64_t cycles;
+  };
+  static TypeTotal totals[kMaxOpRecords];
+  int num_types = 0;
+  uint64_t total_cycles = 0;
+  uint64_t total_macs = 0;
+
+  const bool counters = op_profile_counters_enabled && NUM_PERF_COUNTERS > 0;
+  printf("\"Node\",\"Tag\",\"Inputs\",\"Outputs\",\"MACs\",\"Cycles\"");
+  for (int c = 0; counters && c < NUM_PERF_COUNTERS; c++) {
+    printf(",\"Counter %d\"", c);
+  }
+  printf("\n");
+  for (int i = 0; i < num_records; i++) {
+    const OpRecord& record = records[i];
+    int64_t macs = 0;
+    printf("%d,%s,", i, record.tag);
+    if (i < num_nodes) {
+      const tflite::Operator* op = subgraph->operators()->Get(i);
+      const tflite::BuiltinOperator code = tflite::GetBuiltinCode(
+          profiled_model->operator_codes()->Get(op->opcode_index()));
+      macs = op_macs(subgraph->tensors(), op, code);
+      print_shapes(subgraph->tensors(), op->inputs());
+      printf(",");
+      print_shapes(subgraph->tensors(), op->outputs());
+    } else {
+      printf("\"\",\"\"");
+    }
+    printf(",%lld,%llu", static_cast<long long>(macs),
+           static_cast<unsigned long long>(record.cycles));
+#if NUM_PERF_COUNTERS > 0
+    for (int c = 0; counters && c < NUM_PERF_COUNTERS; c++) {
+      printf(",%lu", static_cast<unsigned long>(record.counters[c]));
+    }
+#endif
+    printf("\n");
+
+    int t = 0;
+    while (t < num_types && strcmp(totals[t].tag, record.tag) != 0) t++;
+    if (t == num_types) {
+      totals[num_types++] = {record.tag, 0, 0, 0};
+    }
+    totals[t].count++;
+    totals[t].macs += macs;
+    totals[t].cycles += record.cycles;
+    total_macs += macs;
+    total_cycles += record.cycles;
+  }
+
+  printf("\"Tag\",\"Count\",\"MACs\",\"Cycles\",\"Cycles %%\"\n");
+  for (int t = 0; t < num_types; t++) {
+    printf("%s,%lu,%llu,%llu,", totals[t].tag,
+           static_cast<unsigned long>(totals[t].count),
+           static_cast<unsigned long long>(totals[t].macs),
+           static_cast<unsigned long long>(totals[t].cycles));
+    print_percent(totals[t].cycles, total_cycles);
+    printf("\n");
+  }
+  printf("Total,%d,%llu,%llu,100.0\n", num_records,
+         static_cast<unsigned long long>(total_macs),
+         static_cast<unsigned long long>(total_cycles));
+#ifdef PHASE_TIMERS
+  phase_timer_print();
+#endif
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _OP_PROFILE_H
+#define _OP_PROFILE_H
+
+// Per-operator cycle profiling, switched at runtime with op_profile_enabled
+// ('p' in the project menu).
+//
+// The interpreter's profiler brackets every op of an Invoke() with
+// op_profile_begin() and op_profile_end(), which time it with the 64-bit
+// cycle counter. Ops are matched to the nodes of subgraph 0 by order, which
+// gives each one its node index, tensor shapes and MAC count. An op invoked
+// from inside another op, such as a WHILE body, is counted in the enclosing
+// op.
+
+#include <stdint.h>
+
+#include "tensorflow/lite/schema/schema_generated.h"
+
+extern bool op_profile_enabled;
+
+// When set ('c' in the project menu), each op also reports how far every
+// perf counter of perf.h advanced while it ran, one column per counter.
+// What a counter counts (cycles, cache misses, stalls, ...) depends on the
+// bitstream.
+extern bool op_profile_counters_enabled;
+
+// The model whose nodes the recorded ops are matched to.
+void op_profile_set_model(const tflite::Model* model);
+
+// Forgets the recorded ops. Called before each Invoke().
+void op_profile_reset(void);
+
+// Enables every perf counter for an Invoke(). Called in counter mode after
+// perf_reset_all_counters().
+void op_profile_start_counters(void);
+
+void op_profile_begin(const char* tag);
+void op_profile_end(void);
+
+// The number of the op being recorded, or -1 outside a recorded op.
+int op_profile_current_op(void);
+
+// The tag of a recorded op.
+const char* op_profile_tag(int op);
+
+// Multiply-accumulates done by an op of subgraph 0 of `model`; zero for ops
+// that are not built on dot products.
+int64_t op_profile_macs(const tflite::Model* model, const tflite::Operator* op);
+
+// Prints one CSV row per recorded op, then the totals per op type, then the
+// phases of phase_timer.h.
+void op_profile_print(void);
+
+#endif  // _OP_PROFILE_H
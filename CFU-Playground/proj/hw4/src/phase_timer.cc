@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "phase_timer.h"
+
+#ifdef PHASE_TIMERS
+
+#include <stdio.h>
+#include <string.h>
+
+#include "op_profile.h"
+
+namespace {
+
+struct Phase {
+  int op;
+  // Index of the enclosing phase, or -1.
+  int parent;
+  const char* name;
+  uint32_t calls;
+  uint64_t cycles;
+};
+
+constexpr int kMaxPhases = 128;
+Phase phases[kMaxPhases];
+int num_phases;
+
+// The innermost open phase, or -1.
+int innermost = -1;
+
+void print_path(int phase) {
+  if (phases[phase].parent >= 0) {
+    print_path(phases[phase].parent);
+    printf("/");
+  }
+  printf("%s", phases[phase].name);
+}
+
+}  // anonymous namespace
+
+int phase_timer_enter(const char* name) {
+  const int op = op_profile_current_op();
+  if (op < 0) return -1;
+
+  // Ops are numbered in order, so the phases of the current op are the last
+  // ones in the table.
+  int phase = num_phases - 1;
+  while (phase >= 0 && phases[phase].op == op &&
+         (phases[phase].parent != innermost ||
+          strcmp(phases[phase].name, name) != 0)) {
+    phase--;
+  }
+  if (phase < 0 || phases[phase].op != op) {
+    if (num_phases == kMaxPhases) return -1;
+    phase = num_phases++;
+    phases[phase] = {op, innermost, name, 0, 0};
+  }
+  innermost = phase;
+  return phase;
+}
+
+void phase_timer_exit(int phase, uint32_t cycles) {
+  if (phase < 0) return;
+  phases[phase].calls++;
+  phases[phase].cycles += cycles;
+  innermost = phases[phase].parent;
+}
+
+void phase_timer_reset(void) {
+  num_phases = 0;
+  innermost = -1;
+}
+
+void phase_timer_print(void) {
+  if (num_phases == 0) return;
+  printf("\"Node\",\"Tag\",\"Phase\",\"Calls\",\"Cycles\"\n");
+  for (int i = 0; i < num_phases; i++) {
+    printf("%d,%s,", phases[i].op, op_profile_tag(phases[i].op));
+    print_path(i);
+    printf(",%lu,%llu\n", static_cast<unsigned long>(phases[i].calls),
+           static_cast<unsigned long long>(phases[i].cycles));
+  }
+}
+
+#endif  // PHASE_TIMERS
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _PHASE_TIMER_H
+#define _PHASE_TIMER_H
+
+// Scoped timers for the phases of a kernel, enabled by defining PHASE_TIMERS.
+//
+//   {
+//     PHASE_TIMER("gemm");
+//     ...
+//   }
+//
+// times the rest of the enclosing block with two mcycle reads. A phase begun
+// inside another is recorded under it, as "gemm/requant". Calls and cycles
+// are summed per op instance, as numbered by op_profile.h, and per phase.
+// op_profile_print() prints them after the per-op rows. Phases are only
+// recorded while the per-op profile is on; kernels never print.
+//
+// Without PHASE_TIMERS, PHASE_TIMER() expands to nothing.
+
+#ifdef PHASE_TIMERS
+
+#include <stdint.h>
+
+#include "perf.h"
+
+// Opens phase `name` under the innermost open phase of the current op and
+// returns its id, or -1 if it is not being recorded.
+int phase_timer_enter(const char* name);
+
+// Closes a phase returned by phase_timer_enter().
+void phase_timer_exit(int phase, uint32_t cycles);
+
+// Forgets the recorded phases. Called by op_profile_reset().
+void phase_timer_reset(void);
+
+// Prints one CSV row per op and phase. Called by op_profile_print().
+void phase_timer_print(void);
+
+class PhaseTimer {
+ public:
+  explicit PhaseTimer(const char* name)
+      : phase_(phase_timer_enter(name)), start_(perf_get_mcycle()) {}
+  ~PhaseTimer() { phase_timer_exit(phase_, perf_get_mcycle() - start_); }
+
+ private:
+  const int phase_;
+  const uint32_t start_;
+};
+
+#define PHASE_TIMER_CONCAT(a, b) a##b
+#define PHASE_TIMER_VARIABLE(n) PHASE_TIMER_CONCAT(phase_timer_, n)
+#define PHASE_TIMER(name) PhaseTimer PHASE_TIMER_VARIABLE(__COUNTER__)(name)
+
+#else
+
+#define PHASE_TIMER(name)
+
+#endif  // PHASE_TIMERS
+
+#endif  // _PHASE_TIMER_H
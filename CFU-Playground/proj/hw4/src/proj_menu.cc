@@ -20,6 +20,8 @@
 
 #include "cfu.h"
 #include "menu.h"
+#include "op_profile.h"
+#include "perf.h"
 
 namespace {
 
@@ -27,9 +29,10 @@ namespace {
 
 void do_hello_world(void) { puts("Hello, World!!!\n"); }
 
-// Test template instruction
-void do_grid_cfu_op0(void) {
-  puts("\nExercise CFU Op0\n");
+// Test template instruction. Op0 and op1 are the SIMD MAC and float units,
+// op2 still passes rs1 through.
+void do_grid_cfu_op2(void) {
+  puts("\nExercise CFU Op2\n");
   printf("a   b-->");
   for (int b = 0; b < 6; b++) {
     printf("%8d", b);
@@ -38,7 +41,7 @@ void do_grid_cfu_op0(void) {
   for (int a = 0; a < 6; a++) {
     printf("%-8d", a);
     for (int b = 0; b < 6; b++) {
-      int cfu = cfu_op0(0, a, b);
+      int cfu = cfu_op2(0, a, b);
       printf("%8d", cfu);
     }
     puts("");
@@ -46,12 +49,12 @@ void do_grid_cfu_op0(void) {
 }
 
 // Test template instruction
-void do_exercise_cfu_op0(void) {
-  puts("\nExercise CFU Op0\n");
+void do_exercise_cfu_op2(void) {
+  puts("\nExercise CFU Op2\n");
   int count = 0;
   for (int a = -0x71234567; a < 0x68000000; a += 0x10012345) {
     for (int b = -0x7edcba98; b < 0x68000000; b += 0x10770077) {
-      int cfu = cfu_op0(0, a, b);
+      int cfu = cfu_op2(0, a, b);
       printf("a: %08x b:%08x cfu=%08x\n", a, b, cfu);
       if (cfu != a) {
         printf("\n***FAIL\n");
@@ -63,13 +66,31 @@ void do_exercise_cfu_op0(void) {
   printf("Performed %d comparisons", count);
 }
 
+void do_toggle_op_profile(void) {
+  op_profile_enabled = !op_profile_enabled;
+  printf("Per-op profile %s\n", op_profile_enabled ? "on" : "off");
+}
+
+void do_toggle_op_profile_counters(void) {
+  if (NUM_PERF_COUNTERS == 0) {
+    puts("Perf counters not enabled.");
+    return;
+  }
+  op_profile_counters_enabled = !op_profile_counters_enabled;
+  printf("Per-op perf counters %s\n",
+         op_profile_counters_enabled ? "on" : "off");
+}
+
 struct Menu MENU = {
     "Project Menu",
     "project",
     {
-        MENU_ITEM('0', "exercise cfu op0", do_exercise_cfu_op0),
-        MENU_ITEM('g', "grid cfu op0", do_grid_cfu_op0),
+        MENU_ITEM('2', "exercise cfu op2", do_exercise_cfu_op2),
+        MENU_ITEM('c', "toggle per-op perf counters",
+                  do_toggle_op_profile_counters),
+        MENU_ITEM('g', "grid cfu op2", do_grid_cfu_op2),
         MENU_ITEM('h', "say Hello", do_hello_world),
+        MENU_ITEM('p', "toggle per-op profile", do_toggle_op_profile),
         MENU_END,
     },
 };
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SIMD_CFU_H
+#define _SIMD_CFU_H
+
+#include <stdint.h>
+
+#include "cfu.h"
+
+// 4-lane int8 multiply-accumulate unit on funct3 0 of the CFU (see cfu.v),
+// with four 32-bit accumulators. A MAC multiplies the four signed bytes of
+// rs1 with the four signed bytes of rs2, adds the sum to one accumulator and
+// returns the new value. There is no input offset; callers fold it into the
+// bias.
+//
+// The accumulator index is part of funct7, so it must be a constant.
+
+#define SIMD_CFU_MAC 0      // funct7 0..3: acc[n] += dot4(rs1, rs2)
+#define SIMD_CFU_SET_ACC 4  // funct7 4..7: acc[n] = rs1
+
+#define simd_cfu_mac(n, rs1, rs2) \
+  static_cast<int32_t>(cfu_op0(SIMD_CFU_MAC + (n), (rs1), (rs2)))
+#define simd_cfu_set_acc(n, value) \
+  cfu_op0(SIMD_CFU_SET_ACC + (n), static_cast<uint32_t>(value), 0)
+
+#endif  // _SIMD_CFU_H
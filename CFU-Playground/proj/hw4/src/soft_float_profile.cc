@@ -0,0 +1,81 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The wrappers must reach the real helpers, so this file is not redirected.
+#define SOFT_FLOAT_PROFILE_NO_REDIRECT
+#include "soft_float_profile.h"
+
+#ifdef SOFT_FLOAT_PROFILE
+
+#include <stdio.h>
+
+#include "perf.h"
+
+uint32_t soft_float_calls;
+uint32_t soft_float_cycles;
+
+namespace {
+
+#define SOFT_FLOAT_NAME(ret, name, params, args) #name,
+const char* const routine_names[kNumSoftFloatRoutines] = {
+    SOFT_FLOAT_ROUTINES(SOFT_FLOAT_NAME)};
+#undef SOFT_FLOAT_NAME
+
+uint32_t routine_calls[kNumSoftFloatRoutines];
+uint64_t routine_cycles[kNumSoftFloatRoutines];
+
+inline void record(SoftFloatRoutine routine, uint32_t cycles) {
+  soft_float_calls++;
+  soft_float_cycles += cycles;
+  routine_calls[routine]++;
+  routine_cycles[routine] += cycles;
+}
+
+}  // anonymous namespace
+
+#define SOFT_FLOAT_WRAPPER(ret, name, params, args)      \
+  extern "C" ret name params;                            \
+  extern "C" ret __wrap_##name params;                   \
+  ret __wrap_##name params {                             \
+    unsigned start = perf_get_mcycle();                  \
+    ret result = name args;                              \
+    record(kSoftFloat_##name, perf_get_mcycle() - start); \
+    return result;                                       \
+  }
+SOFT_FLOAT_ROUTINES(SOFT_FLOAT_WRAPPER)
+#undef SOFT_FLOAT_WRAPPER
+
+void soft_float_profile_reset(void) {
+  soft_float_calls = 0;
+  soft_float_cycles = 0;
+  for (int i = 0; i < kNumSoftFloatRoutines; i++) {
+    routine_calls[i] = 0;
+    routine_cycles[i] = 0;
+  }
+}
+
+void soft_float_profile_print(void) {
+  printf("\"Routine\",\"Calls\",\"Cycles\"\n");
+  for (int i = 0; i < kNumSoftFloatRoutines; i++) {
+    if (routine_calls[i]) {
+      printf("%s,%lu,%llu\n", routine_names[i],
+             static_cast<unsigned long>(routine_calls[i]),
+             static_cast<unsigned long long>(routine_cycles[i]));
+    }
+  }
+}
+
+#endif  // SOFT_FLOAT_PROFILE
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _SOFT_FLOAT_PROFILE_H
+#define _SOFT_FLOAT_PROFILE_H
+
+// Soft-float profiling, enabled by defining SOFT_FLOAT_PROFILE.
+//
+// The CPU has no FPU, so each float or double operation is a call to a
+// compiler-rt helper such as __mulsf3 or __adddf3. The libm functions are
+// built on top of those helpers. Every translation unit that includes this
+// header calls a counting wrapper in place of each helper. The wrapper
+// times the real helper with mcycle. The redirect is a local assembler alias
+// (".set __mulsf3, __wrap___mulsf3"), so the build needs no --wrap linker
+// flags. Helpers called from code that does not include this header, such
+// as libm itself, are counted as part of the enclosing wrapped call.
+//
+// TFLM kernels include this header through kernels/internal/compatibility.h.
+
+#ifdef SOFT_FLOAT_PROFILE
+
+#include <stdint.h>
+
+// X(return type, helper, parameters, arguments)
+#define SOFT_FLOAT_ROUTINES(X)                                   \
+  X(float, __addsf3, (float a, float b), (a, b))                 \
+  X(float, __subsf3, (float a, float b), (a, b))                 \
+  X(float, __mulsf3, (float a, float b), (a, b))                 \
+  X(float, __divsf3, (float a, float b), (a, b))                 \
+  X(int, __eqsf2, (float a, float b), (a, b))                    \
+  X(int, __nesf2, (float a, float b), (a, b))                    \
+  X(int, __ltsf2, (float a, float b), (a, b))                    \
+  X(int, __lesf2, (float a, float b), (a, b))                    \
+  X(int, __gtsf2, (float a, float b), (a, b))                    \
+  X(int, __gesf2, (float a, float b), (a, b))                    \
+  X(int, __unordsf2, (float a, float b), (a, b))                 \
+  X(int, __fixsfsi, (float a), (a))                              \
+  X(unsigned, __fixunssfsi, (float a), (a))                      \
+  X(long long, __fixsfdi, (float a), (a))                        \
+  X(float, __floatsisf, (int a), (a))                            \
+  X(float, __floatunsisf, (unsigned a), (a))                     \
+  X(float, __floatdisf, (long long a), (a))                      \
+  X(double, __extendsfdf2, (float a), (a))                       \
+  X(float, __truncdfsf2, (double a), (a))                        \
+  X(double, __adddf3, (double a, double b), (a, b))              \
+  X(double, __subdf3, (double a, double b), (a, b))              \
+  X(double, __muldf3, (double a, double b), (a, b))              \
+  X(double, __divdf3, (double a, double b), (a, b))              \
+  X(int, __eqdf2, (double a, double b), (a, b))                  \
+  X(int, __nedf2, (double a, double b), (a, b))                  \
+  X(int, __ltdf2, (double a, double b), (a, b))                  \
+  X(int, __ledf2, (double a, double b), (a, b))                  \
+  X(int, __gtdf2, (double a, double b), (a, b))                  \
+  X(int, __gedf2, (double a, double b), (a, b))                  \
+  X(int, __unorddf2, (double a, double b), (a, b))               \
+  X(int, __fixdfsi, (double a), (a))                             \
+  X(unsigned, __fixunsdfsi, (double a), (a))                     \
+  X(long long, __fixdfdi, (double a), (a))                       \
+  X(double, __floatsidf, (int a), (a))                           \
+  X(double, __floatunsidf, (unsigned a), (a))                    \
+  X(double, __floatdidf, (long long a), (a))                     \
+  X(long long, __divdi3, (long long a, long long b), (a, b))     \
+  X(unsigned long long, __udivdi3,                               \
+    (unsigned long long a, unsigned long long b), (a, b))        \
+  X(long long, __moddi3, (long long a, long long b), (a, b))     \
+  X(unsigned long long, __umoddi3,                               \
+    (unsigned long long a, unsigned long long b), (a, b))        \
+  X(float, sqrtf, (float a), (a))                                \
+  X(double, sqrt, (double a), (a))                               \
+  X(float, logf, (float a), (a))                                 \
+  X(double, log, (double a), (a))                                \
+  X(float, expf, (float a), (a))                                 \
+  X(double, exp, (double a), (a))                                \
+  X(float, tanhf, (float a), (a))
+
+#define SOFT_FLOAT_ENUM(ret, name, params, args) kSoftFloat_##name,
+enum SoftFloatRoutine {
+  SOFT_FLOAT_ROUTINES(SOFT_FLOAT_ENUM) kNumSoftFloatRoutines
+};
+#undef SOFT_FLOAT_ENUM
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Calls and cycles across all wrapped routines since the last reset. The
+// cycles wrap at 32 bits, so take differences over short spans such as one
+// operator.
+extern uint32_t soft_float_calls;
+extern uint32_t soft_float_cycles;
+
+void soft_float_profile_reset(void);
+
+// Prints the calls and cycles of each routine called since the last reset.
+void soft_float_profile_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#ifndef SOFT_FLOAT_PROFILE_NO_REDIRECT
+#define SOFT_FLOAT_REDIRECT(ret, name, params, args) \
+  __asm__(".set " #name ", __wrap_" #name);
+SOFT_FLOAT_ROUTINES(SOFT_FLOAT_REDIRECT)
+#undef SOFT_FLOAT_REDIRECT
+#endif
+
+#endif  // SOFT_FLOAT_PROFILE
+
+#endif  // _SOFT_FLOAT_PROFILE_H
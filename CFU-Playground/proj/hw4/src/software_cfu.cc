@@ -0,0 +1,155 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include "software_cfu.h"
+
+namespace {
+
+const uint32_t kCanonicalNan = 0x7fc00000;
+const uint32_t kInfinity = 0x7f800000;
+const uint32_t kOne = 0x3f800000;
+const uint32_t kNegativeZero = 0x80000000;
+
+uint32_t float_acc;
+uint32_t simd_acc[4];
+
+// Sum of the products of the four signed bytes of a and b.
+int32_t dot4(uint32_t a, uint32_t b) {
+  int32_t sum = 0;
+  for (int i = 0; i < 32; i += 8) {
+    sum += static_cast<int8_t>(a >> i) * static_cast<int8_t>(b >> i);
+  }
+  return sum;
+}
+
+// Bit-exact model of the float unit in cfu.v: returns c + a * b with a
+// single round to nearest even. Subnormal inputs read as zero, subnormal
+// results flush to zero and every NaN result is the canonical quiet NaN.
+uint32_t float_fma(uint32_t a, uint32_t b, uint32_t c) {
+  const uint32_t sa = a >> 31, sb = b >> 31, sc = c >> 31;
+  const int ea = (a >> 23) & 0xff, eb = (b >> 23) & 0xff;
+  const int ec = (c >> 23) & 0xff;
+  const uint32_t ma = a & 0x7fffff, mb = b & 0x7fffff, mc = c & 0x7fffff;
+  const uint32_t sp = sa ^ sb;
+
+  if ((ea == 255 && ma) || (eb == 255 && mb) || (ec == 255 && mc)) {
+    return kCanonicalNan;
+  }
+  const bool p_zero = ea == 0 || eb == 0;
+  const bool c_zero = ec == 0;
+  if (ea == 255 || eb == 255) {
+    if (p_zero || (ec == 255 && sc != sp)) return kCanonicalNan;
+    return sp << 31 | kInfinity;
+  }
+  if (ec == 255) return c;
+  if (p_zero) return c_zero ? (sp & sc) << 31 : c;
+
+  // The product is a 48-bit integer scaled by 2^lp. Both addends get three
+  // guard bits; the one with the smaller scale is shifted right, with the
+  // shifted-out bits jammed into its lowest bit.
+  const uint64_t p = static_cast<uint64_t>(ma | 1 << 23) * (mb | 1 << 23);
+  const int lp = ea + eb - 300;
+  uint64_t magnitude;
+  uint32_t sign;
+  int lsb;
+  if (c_zero) {
+    magnitude = p << 3;
+    sign = sp;
+    lsb = lp - 3;
+  } else {
+    const uint64_t cm = static_cast<uint64_t>(mc | 1 << 23) << 24;
+    const int lc = ec - 174;
+    const bool p_big = lp >= lc;
+    const uint64_t x = (p_big ? p : cm) << 3;
+    uint64_t y = (p_big ? cm : p) << 3;
+    const uint32_t sx = p_big ? sp : sc, sy = p_big ? sc : sp;
+    int shift = p_big ? lp - lc : lc - lp;
+    if (shift > 63) shift = 63;
+    const bool sticky = (y & ((uint64_t{1} << shift) - 1)) != 0;
+    y = (y >> shift) | sticky;
+    if (sx == sy) {
+      magnitude = x + y;
+      sign = sx;
+    } else if (x >= y) {
+      magnitude = x - y;
+      sign = sx;
+    } else {
+      magnitude = y - x;
+      sign = sy;
+    }
+    if (magnitude == 0) return 0;
+    lsb = (p_big ? lp : lc) - 3;
+  }
+
+  int msb = 63;
+  while (!(magnitude >> msb)) msb--;
+  int exponent = lsb + msb + 127;
+  uint32_t mantissa;
+  if (msb > 23) {
+    const int shift = msb - 23;
+    const uint64_t rest = magnitude & ((uint64_t{1} << shift) - 1);
+    const uint64_t half = uint64_t{1} << (shift - 1);
+    mantissa = magnitude >> shift;
+    if (rest > half || (rest == half && (mantissa & 1))) mantissa++;
+    if (mantissa >> 24) {
+      mantissa >>= 1;
+      exponent++;
+    }
+  } else {
+    mantissa = magnitude << (23 - msb);
+  }
+  if (exponent >= 255) return sign << 31 | kInfinity;
+  if (exponent <= 0) return sign << 31;
+  return sign << 31 | exponent << 23 | (mantissa & 0x7fffff);
+}
+
+}  // anonymous namespace
+
+//
+// In this function, place C code to emulate your CFU. You can switch between
+// hardware and emulated CFU by setting the CFU_SOFTWARE_DEFINED DEFINE in
+// the Makefile.
+//
+// funct3 0 is the SIMD MAC unit, see simd_cfu.h.
+// funct3 1 is the float unit, see float_cfu.h.
+uint32_t software_cfu(int funct3, int funct7, uint32_t rs1, uint32_t rs2)
+{
+  if (funct3 == 0) {
+    uint32_t& acc = simd_acc[funct7 & 3];
+    if (funct7 < 4) {
+      acc += static_cast<uint32_t>(dot4(rs1, rs2));
+    } else {
+      acc = rs1;
+    }
+    return acc;
+  }
+  if (funct3 == 1) {
+    switch (funct7) {
+      case 1:
+        return float_fma(rs1, kOne, rs2);
+      case 2:
+        float_acc = float_fma(rs1, rs2, float_acc);
+        return float_acc;
+      case 3:
+        float_acc = rs1;
+        return float_acc;
+      default:
+        return float_fma(rs1, rs2, kNegativeZero);
+    }
+  }
+  return (funct3 & 1) ? rs2 : rs1;
+}
@@ -0,0 +1,35 @@
+/* Copyright 2023 The CFU-Playground Authors
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Precision used by the AudioSpectrogram and Mfcc kernels. Define
+// AUDIO_FE_SINGLE_PRECISION in the project Makefile to run the whole front
+// end in float instead of double.
+
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_AUDIO_FEATURE_TYPE_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_AUDIO_FEATURE_TYPE_H_
+
+namespace tflite {
+namespace internal {
+
+#ifdef AUDIO_FE_SINGLE_PRECISION
+typedef float AudioFeatureReal;
+#else
+typedef double AudioFeatureReal;
+#endif
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_AUDIO_FEATURE_TYPE_H_
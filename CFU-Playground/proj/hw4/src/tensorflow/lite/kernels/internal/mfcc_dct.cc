@@ -0,0 +1,96 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/mfcc_dct.h"
+
+#include <math.h>
+#include <cmath>
+#include <cstdio>
+
+#include "soft_float_profile.h"
+
+
+namespace tflite {
+namespace internal {
+
+//double cosines_[30][80];
+
+template <class Real>
+MfccDct<Real>::MfccDct() : initialized_(false) {}
+
+template <class Real>
+bool MfccDct<Real>::Initialize(int input_length, int coefficient_count) {
+  coefficient_count_ = coefficient_count; // mfcc output size, 30
+  input_length_ = input_length; // mel_filterbank_.Compute() outpit size, 80
+
+  if (coefficient_count_ < 1) {
+    return false;
+  }
+
+  if (input_length < 1) {
+    return false;
+  }
+
+  if (coefficient_count_ > input_length_) {
+    return false;
+  }
+
+  // cosines_.resize(coefficient_count_); // r x c = coefficient_count_ x input_length_ = 13 x 40, type = double
+  Real fnorm = std::sqrt(static_cast<Real>(2) / input_length_);
+  // Some platforms don't have M_PI, so define a local constant here.
+  const Real pi = std::atan(static_cast<Real>(1)) * 4;
+  Real arg = pi / input_length_;
+  for (int i = 0; i < coefficient_count_; ++i) {
+    // cosines_[i].resize(input_length_);
+    for (int j = 0; j < input_length_; ++j) {
+      cosines_[i][j] = fnorm * std::cos(i * arg * (j + static_cast<Real>(0.5)));
+    }
+  }
+
+  initialized_ = true;
+  return true;
+}
+
+template <class Real>
+void MfccDct<Real>::Compute(const Real* input, size_t size,
+                            float* output) const { //arr[80], 80, arr[30]
+  //printf("in MfccDct:: Compute\n");
+
+  if (!initialized_) {
+    return;
+  }
+
+  /*
+  output->resize(coefficient_count_);
+    int length = input.size();
+    if (length > input_length_) {
+       length = input_length_;
+  }
+  */
+
+  for (int i = 0; i < coefficient_count_; ++i) { // 30
+    Real sum = 0;
+    for (unsigned int j = 0; j < size; ++j) { // 80
+      sum += cosines_[i][j] * input[j];
+    }
+    output[i] = sum;
+  }
+}
+
+template class MfccDct<double>;
+template class MfccDct<float>;
+
+}  // namespace internal
+}  // namespace tflite
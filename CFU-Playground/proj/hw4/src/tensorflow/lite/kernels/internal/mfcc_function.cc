@@ -0,0 +1,80 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <math.h>
+#include <cmath>
+#include <cstdio>
+
+#include "tensorflow/lite/kernels/internal/mfcc.h"
+
+#include "soft_float_profile.h"
+
+namespace tflite {
+namespace internal {
+
+const double kDefaultUpperFrequencyLimit = 4000;
+const double kDefaultLowerFrequencyLimit = 20;
+const double kFilterbankFloor = 1e-12;
+const int kDefaultFilterbankChannelCount = 40; //typically
+const int kDefaultDCTCoefficientCount = 13;
+
+template <class Real>
+Mfcc<Real>::Mfcc()
+    : initialized_(false),
+      lower_frequency_limit_(static_cast<Real>(kDefaultLowerFrequencyLimit)),
+      upper_frequency_limit_(static_cast<Real>(kDefaultUpperFrequencyLimit)),
+      filterbank_channel_count_(kDefaultFilterbankChannelCount),
+      dct_coefficient_count_(kDefaultDCTCoefficientCount) {}
+
+template <class Real>
+bool Mfcc<Real>::Initialize(int input_length, Real input_sample_rate) {
+  bool initialized = mel_filterbank_.Initialize(
+      input_length, input_sample_rate, filterbank_channel_count_,
+      lower_frequency_limit_, upper_frequency_limit_);
+
+
+  initialized &=
+      dct_.Initialize(filterbank_channel_count_, dct_coefficient_count_); // 40, 13
+  initialized_ = initialized;
+
+  return initialized;
+}
+
+template <class Real>
+void Mfcc<Real>::Compute(const float* spectrogram_frame, size_t size, float* output) const { //arr[513], 513, arr[30]
+
+  if (!initialized_) {
+    // LOG(ERROR) << "Mfcc not initialized.";
+    return;
+  }
+
+  size_t working_size = mel_filterbank_.Compute(spectrogram_frame, size, working_); //arr[513], 513, arr[80]
+  // size = 80, change the following 80 to size will output wrong answer
+  const Real filterbank_floor = static_cast<Real>(kFilterbankFloor);
+  for (unsigned int i = 0; i < working_size; ++i) { // working array only has size of 80
+    Real val = working_[i];
+    if (val < filterbank_floor) {
+      val = filterbank_floor;
+    }
+    working_[i] = std::log(val);
+  }
+  dct_.Compute(working_, working_size, output); //arr[80], 80, arr[30]
+}
+
+template class Mfcc<double>;
+template class Mfcc<float>;
+
+}  // namespace internal
+}  // namespace tflite
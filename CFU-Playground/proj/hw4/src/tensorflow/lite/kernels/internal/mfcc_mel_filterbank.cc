@@ -0,0 +1,283 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This code resamples the FFT bins, and smooths then with triangle-shaped
+// weights to create a mel-frequency filter bank. For filter i centered at f_i,
+// there is a triangular weighting of the FFT bins that extends from
+// filter f_i-1 (with a value of zero at the left edge of the triangle) to f_i
+// (where the filter value is 1) to f_i+1 (where the filter values returns to
+// zero).
+
+// Note: this code fails if you ask for too many channels.  The algorithm used
+// here assumes that each FFT bin contributes to at most two channels: the
+// right side of a triangle for channel i, and the left side of the triangle
+// for channel i+1.  If you ask for so many channels that some of the
+// resulting mel triangle filters are smaller than a single FFT bin, these
+// channels may end up with no contributing FFT bins.  The resulting mel
+// spectrum output will have some channels that are always zero.
+
+#include "tensorflow/lite/kernels/internal/mfcc_mel_filterbank.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "soft_float_profile.h"
+
+/*
+char* uint32_to_dec_cstring(char buf[11], uint32_t n) {
+  for (int i{9}; i >= 0; --i) {
+    // printf("iterating\n");
+    buf[i] = '0' + n % 10;
+    n /= 10;
+  }
+  buf[10] = '\0';
+  return buf;
+}
+*/
+/*
+  printf("[DEBUG] Before\n"); // replace printf(); to know the size of output array
+  fflush(stdout);
+  char num[11];
+  uint32_to_dec_cstring(num, num_channels_); // 80
+  char buf[50] = "num_channels_=";
+  strcat(strcat(buf, num), "\n");
+  fwrite(buf, sizeof(char), sizeof(buf), stderr);
+  printf("[DEBUG] After\n");
+  fflush(stdout);
+*/
+
+namespace tflite {
+namespace internal {
+
+template <class Real>
+MfccMelFilterbank<Real>::MfccMelFilterbank() : initialized_(false) {}
+
+template <class Real>
+bool MfccMelFilterbank<Real>::Initialize(int input_length, Real input_sample_rate,
+                                         int output_channel_count,
+                                         Real lower_frequency_limit,
+                                         Real upper_frequency_limit) {
+  
+  num_channels_ = output_channel_count;
+  sample_rate_ = input_sample_rate;
+  input_length_ = input_length;
+
+  // printf("num_channels + 1 = %d\n", num_channels_ + 1); //81
+  // printf("input_length_ = %d\n", input_length_); // 513
+
+  if (num_channels_ < 1) {
+    // LOG(ERROR) << "Number of filterbank channels must be positive.";
+    return false;
+  }
+
+  if (sample_rate_ <= 0) {
+    // LOG(ERROR) << "Sample rate must be positive.";
+    return false;
+  }
+
+  if (input_length < 2) {
+    // LOG(ERROR) << "Input length must greater than 1.";
+    return false;
+  }
+
+  if (lower_frequency_limit < 0) {
+    // LOG(ERROR) << "Lower frequency limit must be nonnegative.";
+    return false;
+  }
+
+  if (upper_frequency_limit <= lower_frequency_limit) {
+    /// LOG(ERROR) << "Upper frequency limit must be greater than "
+    //           << "lower frequency limit.";
+    return false;
+  }
+  
+
+  // An extra center frequency is computed at the top to get the upper
+  // limit on the high side of the final triangular filter.
+  //center_frequencies_.resize(num_channels_ + 1); 
+  const Real mel_low = FreqToMel(lower_frequency_limit);
+  const Real mel_hi = FreqToMel(upper_frequency_limit);
+  const Real mel_span = mel_hi - mel_low;
+  const Real mel_spacing = mel_span / static_cast<Real>(num_channels_ + 1);
+  for (int i = 0; i < num_channels_ + 1; ++i) {
+    center_frequencies_[i] = mel_low + (mel_spacing * (i + 1));
+  }
+
+  // Always exclude DC; emulate HTK.
+  const Real hz_per_sbin =
+      static_cast<Real>(0.5) * sample_rate_ / static_cast<Real>(input_length_ - 1);
+  start_index_ = static_cast<int>(static_cast<Real>(1.5) + (lower_frequency_limit / hz_per_sbin));
+  end_index_ = static_cast<int>(upper_frequency_limit / hz_per_sbin);
+
+
+  // The bins of the filter bank must lie in the input spectrum, so an upper
+  // frequency limit above Nyquist is rejected.
+  if (num_channels_ > MelWeightTable<Real>::kMaxBands ||
+      input_length_ > 513 || start_index_ < 0 ||
+      end_index_ > input_length_) {
+    return false;
+  }
+
+  // Maps the input spectrum bin indices to filter bank channels/indices. For
+  // each FFT bin, band_mapper tells us which channel this bin contributes to
+  // on the right side of the triangle.  Thus this bin also contributes to the
+  // left side of the next channel's triangle response. Compute only reads
+  // bins start_index_ .. end_index_ - 1, so only those are mapped.
+  int band_mapper[513];
+  int channel = 0;
+  for (int i = start_index_; i < end_index_; ++i) {
+    Real melf = FreqToMel(i * hz_per_sbin);
+    while ((channel < num_channels_) &&
+           (center_frequencies_[channel] < melf)) {
+      ++channel;
+    }
+    band_mapper[i] = channel - 1;  // Can be == -1
+  }
+
+  // band_mapper is nondecreasing, so the bins of every band are contiguous:
+  // the left-side bins (mapped to c - 1) followed by the right-side bins
+  // (mapped to c). Count them to lay out the table.
+  for (int c = 0; c < num_channels_; ++c) {
+    table_.band_start[c] = 0;
+    table_.band_length[c] = 0;
+  }
+  for (int i = start_index_; i < end_index_; ++i) {
+    channel = band_mapper[i];
+    if (channel >= 0) ++table_.band_length[channel];
+    if (channel + 1 < num_channels_) ++table_.band_length[channel + 1];
+  }
+  int offset = 0;
+  for (int c = 0; c < num_channels_; ++c) {
+    table_.band_offset[c] = offset;
+    offset += table_.band_length[c];
+    table_.band_length[c] = 0;
+  }
+
+  // Create the weighting functions to taper the band edges.  The contribution
+  // of any one FFT bin is based on its distance along the continuum between two
+  // mel-channel center frequencies.  This bin contributes weight to the
+  // current channel and 1-weight to the next channel.
+  for (int i = start_index_; i < end_index_; ++i) {
+    channel = band_mapper[i];
+    Real weight;
+    if (channel >= 0) {
+      weight =
+          (center_frequencies_[channel + 1] - FreqToMel(i * hz_per_sbin)) /
+          (center_frequencies_[channel + 1] - center_frequencies_[channel]);
+    } else {
+      weight = (center_frequencies_[0] - FreqToMel(i * hz_per_sbin)) /
+               (center_frequencies_[0] - mel_low);
+    }
+    for (int side = 0; side < 2; ++side, ++channel) {
+      if (channel < 0 || channel >= num_channels_) continue;
+      int& length = table_.band_length[channel];
+      if (length == 0) table_.band_start[channel] = i;
+      table_.weights[table_.band_offset[channel] + length++] =
+          side == 0 ? weight : 1 - weight;
+    }
+  }
+
+  // Check the sum of FFT bin weights for every mel band to identify
+  // situations where the mel bands are so narrow that they don't get
+  // significant weight on enough (or any) FFT bins -- i.e., too many
+  // mel bands have been requested for the given FFT size.
+#if 0
+  std::vector<int> bad_channels;
+  for (int c = 0; c < num_channels_; ++c) {
+    float band_weights_sum = 0.0;
+    for (int k = 0; k < table_.band_length[c]; ++k) {
+      band_weights_sum += table_.weights[table_.band_offset[c] + k];
+    }
+    // The lowest mel channels have the fewest FFT bins and the lowest
+    // weights sum.  But given that the target gain at the center frequency
+    // is 1.0, if the total sum of weights is 0.5, we're in bad shape.
+    // printf("band_weights_sum = %f\n", band_weights_sum);
+    if (band_weights_sum < 0.5) {
+      bad_channels.push_back(c);
+    }
+  }
+
+  if (!bad_channels.empty()) {
+    // The following are commented out so that "bad_channels" vector might not necessary
+    LOG(ERROR) << "Missing " << bad_channels.size() << " bands "
+               << " starting at " << bad_channels[0]
+               << " in mel-frequency design. "
+               << "Perhaps too many channels or "
+               << "not enough frequency resolution in spectrum. ("
+               << "input_length: " << input_length
+               << " input_sample_rate: " << input_sample_rate
+               << " output_channel_count: " << output_channel_count
+               << " lower_frequency_limit: " << lower_frequency_limit
+               << " upper_frequency_limit: " << upper_frequency_limit;
+  }
+#endif
+
+  initialized_ = true;
+  return true;
+}
+
+
+
+// Compute the mel spectrum from the squared-magnitude FFT input by taking the
+// square root, then summing FFT magnitudes under triangular integration windows
+// whose widths increase with frequency.
+template <class Real>
+size_t MfccMelFilterbank<Real>::Compute(const float* input, size_t size,
+                                      Real* output) const { // arr[513], 513, arr[80]
+
+  if (!initialized_) {
+    // LOG(ERROR) << "Mel Filterbank not initialized.";
+    return -1;
+  }
+
+  if ((int)size <= end_index_) {
+    // LOG(ERROR) << "Input too short to compute filterbank";
+    return -1;
+  }
+
+  for (int i = start_index_; i < end_index_; i++) {
+    magnitudes_[i] = std::sqrt(static_cast<Real>(input[i]));
+  }
+
+  // Right side of triangle c is the downward slope, left side the upward one.
+  for (int c = 0; c < num_channels_; ++c) {
+    const Real* magnitudes = magnitudes_ + table_.band_start[c];
+    const Real* weights = table_.weights + table_.band_offset[c];
+    const int length = table_.band_length[c];
+    Real sum = 0;
+    for (int k = 0; k < length; ++k) {
+      sum += magnitudes[k] * weights[k];
+    }
+    output[c] = sum;
+  }
+  /*
+  if (channel < num_channels_)
+    return num_channels_;
+  return channel;
+  */
+  return num_channels_;
+}
+
+template <class Real>
+Real MfccMelFilterbank<Real>::FreqToMel(Real freq) const {
+  return static_cast<Real>(1127) * std::log1p(freq / static_cast<Real>(700));
+}
+
+template class MfccMelFilterbank<double>;
+template class MfccMelFilterbank<float>;
+
+}  // namespace internal
+}  // namespace tflite
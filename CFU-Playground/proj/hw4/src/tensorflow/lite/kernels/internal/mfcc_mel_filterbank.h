@@ -0,0 +1,84 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Basic class for applying a mel-scale mapping to a power spectrum.
+
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_MFCC_MEL_FILTERBANK_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_MFCC_MEL_FILTERBANK_H_
+
+#include <cstdio> // for size_t declaration
+
+namespace tflite {
+namespace internal {
+
+// Compressed sparse row form of the triangular mel weights. Band c covers the
+// FFT bins band_start[c] .. band_start[c] + band_length[c] - 1, and their
+// weights are stored contiguously from weights[band_offset[c]]. Only bins
+// under a band's triangle are stored, so a band is a plain dot product. The
+// table is independent of how the weights are applied: the floating-point
+// filterbank uses Weight = Real, and a fixed-point one can keep the bin
+// ranges and swap in integer weights.
+template <class Weight>
+struct MelWeightTable {
+  static const int kMaxBands = 80;
+  // Every FFT bin is on the slopes of at most two bands.
+  static const int kMaxWeights = 2 * 513;
+
+  int band_start[kMaxBands];
+  int band_length[kMaxBands];
+  int band_offset[kMaxBands];
+  Weight weights[kMaxWeights];
+};
+
+// Real is the type of the weights and the accumulators, see Mfcc.
+template <class Real>
+class MfccMelFilterbank {
+ public:
+  MfccMelFilterbank();
+  bool Initialize(int input_length,  // Number of unique FFT bins fftsize/2+1.
+                  Real input_sample_rate, int output_channel_count,
+                  Real lower_frequency_limit, Real upper_frequency_limit);
+
+  // Takes a squared-magnitude spectrogram slice as input, computes a
+  // triangular-mel-weighted linear-magnitude filterbank, and places the result
+  // in output.
+  size_t Compute(const float* input, size_t size,
+               Real* output) const;
+
+  const MelWeightTable<Real>& table() const { return table_; }
+
+ private:
+  Real FreqToMel(Real freq) const;
+  bool initialized_;
+  int num_channels_;
+  Real sample_rate_;
+  int input_length_;
+  //std::vector<double> center_frequencies_;  // In mel, for each mel channel.
+  Real center_frequencies_[81];
+
+  // Weights of every band, built by Initialize.
+  MelWeightTable<Real> table_;
+
+  // Linear magnitude of each FFT bin, shared by the two bands it feeds.
+  mutable Real magnitudes_[513];
+
+  int start_index_;  // Lowest FFT bin used to calculate mel spectrum.
+  int end_index_;    // Highest FFT bin used to calculate mel spectrum.
+};
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_MFCC_MEL_FILTERBANK_H_
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_PACKED_INT8_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_PACKED_INT8_H_
+
+#include <stdint.h>
+
+namespace tflite {
+
+// Four int8 values in one 32-bit word, the first in the low byte. Kernels
+// that read or write int8 tensor data a word at a time go through pointers
+// to this type rather than uint32_t*: may_alias keeps that defined under
+// -fstrict-aliasing, and GCC still moves each word with a single lw or sw.
+// The data must be 4-byte aligned.
+typedef uint32_t PackedInt8x4 __attribute__((__may_alias__));
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_PACKED_INT8_H_
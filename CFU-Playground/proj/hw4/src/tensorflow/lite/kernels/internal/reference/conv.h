@@ -17,14 +17,14 @@ limitations under the License.
 
 #include <algorithm>
 
-#include "models/my_cycles.h"
-#include "perf.h"
+#ifdef FLOAT_CFU
+#include "float_cfu.h"
+#endif
+#include "phase_timer.h"
 #include "playground_util/print_params.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 
-extern long long unsigned my_cycles;
-
 namespace tflite {
 
 namespace reference_ops {
@@ -69,6 +69,9 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape, cons
                 for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
                     auto group = out_channel / filters_per_group;
                     float total = 0.f;
+#ifdef FLOAT_CFU
+                    float_cfu_set_acc(0.f);
+#endif
                     for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
                         const int in_y = in_y_origin + dilation_height_factor * filter_y;
                         for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
@@ -83,8 +86,7 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape, cons
                                 continue;
                             }
 
-                            // LR
-                            unsigned my_start = perf_get_mcycle();
+                            PHASE_TIMER("mac");
                             for (int in_channel = 0; in_channel < filter_input_depth;
                                  ++in_channel) {
                                 float input_value =
@@ -92,18 +94,25 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape, cons
                                                       in_channel + group * filter_input_depth)];
                                 float filter_value = filter_data[Offset(
                                     filter_shape, out_channel, filter_y, filter_x, in_channel)];
+#ifdef FLOAT_CFU
+                                total = float_cfu_mac(input_value, filter_value);
+#else
                                 total += (input_value * filter_value);
+#endif
                             }
-                            unsigned my_finish = perf_get_mcycle();
-                            my_cycles += (my_finish - my_start);
                         }
                     }
                     float bias_value = 0.0f;
                     if (bias_data) {
                         bias_value = bias_data[out_channel];
                     }
+#ifdef FLOAT_CFU
+                    total = float_cfu_add(total, bias_value);
+#else
+                    total += bias_value;
+#endif
                     output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
-                        ActivationFunctionWithMinMax(total + bias_value,
+                        ActivationFunctionWithMinMax(total,
                                                      output_activation_min,
                                                      output_activation_max);
                 }
@@ -172,8 +181,7 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape, cons
                                 continue;
                             }
 
-                            // LR
-                            unsigned my_start = perf_get_mcycle();
+                            PHASE_TIMER("mac");
                             for (int in_channel = 0; in_channel < filter_input_depth;
                                  ++in_channel) {
                                 int32_t input_val =
@@ -184,8 +192,6 @@ inline void Conv(const ConvParams& params, const RuntimeShape& input_shape, cons
                                 acc +=
                                     (filter_val + filter_offset) * (input_val + input_offset);
                             }
-                            unsigned my_finish = perf_get_mcycle();
-                            my_cycles += (my_finish - my_start);
                         }
                     }
                     if (bias_data) {
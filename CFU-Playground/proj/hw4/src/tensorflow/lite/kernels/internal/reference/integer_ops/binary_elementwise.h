@@ -0,0 +1,132 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_BINARY_ELEMENTWISE_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_BINARY_ELEMENTWISE_H_
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+
+namespace tflite {
+namespace reference_integer_ops {
+
+// Loops shared by the quantized Add and Mul kernels. Op is a function object
+// with T operator()(T, T) const, built once per call with the parameters
+// already decoded.
+
+// output[i] = op(input1[i * input1_stride], input2[i * input2_stride]) for
+// strides of 0 (broadcast value) or 1, four elements per iteration.
+template <typename T, typename Op>
+inline void BinaryElementwiseRun(int size, const T* input1_data,
+                                 int input1_stride, const T* input2_data,
+                                 int input2_stride, T* output_data,
+                                 const Op& op) {
+  int i = 0;
+  if (input1_stride == 1 && input2_stride == 1) {
+    for (; i <= size - 4; i += 4) {
+      const T out0 = op(input1_data[i], input2_data[i]);
+      const T out1 = op(input1_data[i + 1], input2_data[i + 1]);
+      const T out2 = op(input1_data[i + 2], input2_data[i + 2]);
+      const T out3 = op(input1_data[i + 3], input2_data[i + 3]);
+      output_data[i] = out0;
+      output_data[i + 1] = out1;
+      output_data[i + 2] = out2;
+      output_data[i + 3] = out3;
+    }
+  } else if (input1_stride == 0 && input2_stride == 1) {
+    const T input1_val = input1_data[0];
+    for (; i <= size - 4; i += 4) {
+      const T out0 = op(input1_val, input2_data[i]);
+      const T out1 = op(input1_val, input2_data[i + 1]);
+      const T out2 = op(input1_val, input2_data[i + 2]);
+      const T out3 = op(input1_val, input2_data[i + 3]);
+      output_data[i] = out0;
+      output_data[i + 1] = out1;
+      output_data[i + 2] = out2;
+      output_data[i + 3] = out3;
+    }
+  } else if (input1_stride == 1 && input2_stride == 0) {
+    const T input2_val = input2_data[0];
+    for (; i <= size - 4; i += 4) {
+      const T out0 = op(input1_data[i], input2_val);
+      const T out1 = op(input1_data[i + 1], input2_val);
+      const T out2 = op(input1_data[i + 2], input2_val);
+      const T out3 = op(input1_data[i + 3], input2_val);
+      output_data[i] = out0;
+      output_data[i + 1] = out1;
+      output_data[i + 2] = out2;
+      output_data[i + 3] = out3;
+    }
+  }
+  for (; i < size; ++i) {
+    output_data[i] =
+        op(input1_data[i * input1_stride], input2_data[i * input2_stride]);
+  }
+}
+
+// 4D broadcast. Trailing dimensions along which both inputs are contiguous
+// or both broadcast are folded into one run, so a same-shape pair or a
+// per-channel operand takes one BinaryElementwiseRun per row or per tensor
+// rather than an Offset() per element.
+template <typename T, typename Op>
+inline void BroadcastBinaryElementwise4D(const RuntimeShape& input1_shape,
+                                         const T* input1_data,
+                                         const RuntimeShape& input2_shape,
+                                         const T* input2_data,
+                                         const RuntimeShape& output_shape,
+                                         T* output_data, const Op& op) {
+  NdArrayDesc<4> desc1;
+  NdArrayDesc<4> desc2;
+  NdArrayDescsForElementwiseBroadcast(input1_shape, input2_shape, &desc1,
+                                      &desc2);
+  const RuntimeShape extended_output_shape =
+      RuntimeShape::ExtendedShape(4, output_shape);
+
+  int extents[4];
+  for (int d = 0; d < 4; ++d) {
+    extents[d] = extended_output_shape.Dims(d);
+  }
+  const int input1_stride = desc1.strides[3];
+  const int input2_stride = desc2.strides[3];
+  for (int d = 2; d >= 0; --d) {
+    if (extents[d] != 1 && (desc1.strides[d] != extents[3] * input1_stride ||
+                            desc2.strides[d] != extents[3] * input2_stride)) {
+      break;
+    }
+    extents[3] *= extents[d];
+    extents[d] = 1;
+  }
+
+  const int run = extents[3];
+  for (int b = 0; b < extents[0]; ++b) {
+    for (int y = 0; y < extents[1]; ++y) {
+      const T* input1_row =
+          input1_data + b * desc1.strides[0] + y * desc1.strides[1];
+      const T* input2_row =
+          input2_data + b * desc2.strides[0] + y * desc2.strides[1];
+      for (int x = 0; x < extents[2]; ++x) {
+        BinaryElementwiseRun(run, input1_row, input1_stride, input2_row,
+                             input2_stride, output_data, op);
+        input1_row += desc1.strides[2];
+        input2_row += desc2.strides[2];
+        output_data += run;
+      }
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_BINARY_ELEMENTWISE_H_
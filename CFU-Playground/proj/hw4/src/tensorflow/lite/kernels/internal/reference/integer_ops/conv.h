@@ -18,7 +18,7 @@ limitations under the License.
 #include <stdio.h>
 #include <algorithm>
 
-#include "models/my_cycles.h"
+#include "phase_timer.h"
 #include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/portable_tensor_utils.h"
 
@@ -96,6 +96,16 @@ namespace reference_integer_ops {
 #define MAX_HWC_SIZE 512
 #define MAX_WINDOW_COUNT 4096
 
+// Whether the im2col matrices of ConvPerChannel fit the MAX_* sizes above.
+inline bool ConvPerChannelFitsIm2col(const RuntimeShape& filter_shape,
+                                     const RuntimeShape& output_shape) {
+    const int HWC = filter_shape.Dims(1) * filter_shape.Dims(2) * filter_shape.Dims(3);
+    const int max_window_sliding_time = output_shape.Dims(1) * output_shape.Dims(2);
+    const int filter_number = filter_shape.Dims(0);
+    return HWC <= MAX_HWC_SIZE && max_window_sliding_time <= MAX_WINDOW_COUNT &&
+           filter_number <= MAX_CHANNEL_SIZE;
+}
+
 // Fixed-point per-channel-quantization convolution reference kernel.
 inline void ConvPerChannel(
     const ConvParams& params,
@@ -160,34 +170,32 @@ inline void ConvPerChannel(
     int max_window_sliding_time = output_height * output_width;
     int filter_number = output_depth;
 
-    // Check if exceeds the defined max size of the matrix
-    printf("HWC: %d, max_window_sliding_time: %d, filter_number: %d\n", HWC, max_window_sliding_time, filter_number);
-    printf("MAX_HWC_SIZE: %d, MAX_WINDOW_COUNT: %d, MAX_CHANNEL_SIZE: %d\n", MAX_HWC_SIZE, MAX_WINDOW_COUNT, MAX_CHANNEL_SIZE);
-    if (HWC > MAX_HWC_SIZE || max_window_sliding_time > MAX_WINDOW_COUNT || filter_number > MAX_CHANNEL_SIZE) {
-        printf("ERROR: matrix size exceeds the defined max size. \n");
-        return;
-    }
+    // The conv kernel rejects larger layers in Prepare.
+    TFLITE_DCHECK(ConvPerChannelFitsIm2col(filter_shape, output_shape));
 
     for (int batch = 0; batch < batches; ++batch) {
-        // im2col for input,  (HxWxC, window sliding time)
-        for (int out_y = 0; out_y < output_height; ++out_y) {
-            const int in_y_origin = (out_y * stride_height) - pad_height;
-            for (int out_x = 0; out_x < output_width; ++out_x) {
-                const int in_x_origin = (out_x * stride_width) - pad_width;
-                for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
-                    auto group = out_channel / filters_per_group;
-                    for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
-                        const int in_y = in_y_origin + dilation_height_factor * filter_y;
-                        for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
-                            const int in_x = in_x_origin + dilation_width_factor * filter_x;
-                            for (int in_channel = 0; in_channel < filter_input_depth; ++in_channel) {
-                                int hwc_index = in_channel + filter_input_depth * (filter_x + filter_width * filter_y);
-                                int window_index = out_y * output_width + out_x;
-                                if (in_x < 0 || in_x >= input_width || in_y < 0 || in_y >= input_height) {
-                                    input_im2col[hwc_index][window_index] = 0;
-                                } else {
-                                    int32_t input_val = input_data[Offset(input_shape, batch, in_y, in_x, in_channel + group * filter_input_depth)];
-                                    input_im2col[hwc_index][window_index] = input_val + input_offset;
+        {
+            PHASE_TIMER("im2col");
+            // im2col for input,  (HxWxC, window sliding time)
+            for (int out_y = 0; out_y < output_height; ++out_y) {
+                const int in_y_origin = (out_y * stride_height) - pad_height;
+                for (int out_x = 0; out_x < output_width; ++out_x) {
+                    const int in_x_origin = (out_x * stride_width) - pad_width;
+                    for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+                        auto group = out_channel / filters_per_group;
+                        for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+                            const int in_y = in_y_origin + dilation_height_factor * filter_y;
+                            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                                const int in_x = in_x_origin + dilation_width_factor * filter_x;
+                                for (int in_channel = 0; in_channel < filter_input_depth; ++in_channel) {
+                                    int hwc_index = in_channel + filter_input_depth * (filter_x + filter_width * filter_y);
+                                    int window_index = out_y * output_width + out_x;
+                                    if (in_x < 0 || in_x >= input_width || in_y < 0 || in_y >= input_height) {
+                                        input_im2col[hwc_index][window_index] = 0;
+                                    } else {
+                                        int32_t input_val = input_data[Offset(input_shape, batch, in_y, in_x, in_channel + group * filter_input_depth)];
+                                        input_im2col[hwc_index][window_index] = input_val + input_offset;
+                                    }
                                 }
                             }
                         }
@@ -195,62 +203,65 @@ inline void ConvPerChannel(
                 }
             }
         }
-        printf("im2col for input done. \n");
 
-        // reshape filter to 2D (N, HxWxC)
-        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
-            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
-                for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
-                    for (int in_channel = 0; in_channel < filter_input_depth; ++in_channel) {
-                        int32_t filter_val = filter_data[Offset(filter_shape, out_channel, filter_y, filter_x, in_channel)];
-
-                        int number_index = out_channel;
-                        int hwc_index = in_channel + filter_input_depth * (filter_x + filter_width * filter_y);
-                        weight_im2col[number_index][hwc_index] = filter_val;
-                        // printf(" %4d ", weight_im2col[number_index][hwc_index]);
+        {
+            PHASE_TIMER("pack_filter");
+            // reshape filter to 2D (N, HxWxC)
+            for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+                for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+                    for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                        for (int in_channel = 0; in_channel < filter_input_depth; ++in_channel) {
+                            int32_t filter_val = filter_data[Offset(filter_shape, out_channel, filter_y, filter_x, in_channel)];
+
+                            int number_index = out_channel;
+                            int hwc_index = in_channel + filter_input_depth * (filter_x + filter_width * filter_y);
+                            weight_im2col[number_index][hwc_index] = filter_val;
+                            // printf(" %4d ", weight_im2col[number_index][hwc_index]);
+                        }
                     }
                 }
+                // printf("\n");
             }
-            // printf("\n");
         }
-        printf("reshape filter to 2D done. \n");
-
-        // record MAC
-        unsigned my_start = perf_get_mcycle();
-        // perform matrix multiplication (N, HxWxC) x (HxWxC, window sliding time) = (N, window sliding time)
-        for (int i = 0; i < filter_number; ++i) {
-            for (int j = 0; j < max_window_sliding_time; ++j) {
-                int32_t sum = 0;
-                for (int k = 0; k < HWC; ++k) {
-                    sum += weight_im2col[i][k] * input_im2col[k][j];
+
+        {
+            PHASE_TIMER("gemm");
+            // perform matrix multiplication (N, HxWxC) x (HxWxC, window sliding time) = (N, window sliding time)
+            for (int i = 0; i < filter_number; ++i) {
+                for (int j = 0; j < max_window_sliding_time; ++j) {
+                    int32_t sum = 0;
+                    for (int k = 0; k < HWC; ++k) {
+                        sum += weight_im2col[i][k] * input_im2col[k][j];
+                    }
+                    result_im2col[i][j] = sum;
                 }
-                result_im2col[i][j] = sum;
             }
         }
         // printf("matrix multiplication done. \n");
 
-        // convert the result matrix back to output format
-        for (int out_y = 0; out_y < output_height; ++out_y) {
-            for (int out_x = 0; out_x < output_width; ++out_x) {
-                for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
-                    int number_index = out_channel;
-                    int window_index = out_y * output_width + out_x;
-                    int32_t acc = result_im2col[number_index][window_index];
-                    if (bias_data) {
-                        acc += bias_data[out_channel];
+        {
+            PHASE_TIMER("requant");
+            // convert the result matrix back to output format
+            for (int out_y = 0; out_y < output_height; ++out_y) {
+                for (int out_x = 0; out_x < output_width; ++out_x) {
+                    for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+                        int number_index = out_channel;
+                        int window_index = out_y * output_width + out_x;
+                        int32_t acc = result_im2col[number_index][window_index];
+                        if (bias_data) {
+                            acc += bias_data[out_channel];
+                        }
+                        acc = MultiplyByQuantizedMultiplier(
+                            acc, output_multiplier[out_channel], output_shift[out_channel]);
+                        acc += output_offset;
+                        acc = std::max(acc, output_activation_min);
+                        acc = std::min(acc, output_activation_max);
+                        output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
+                            static_cast<int8_t>(acc);
                     }
-                    acc = MultiplyByQuantizedMultiplier(
-                        acc, output_multiplier[out_channel], output_shift[out_channel]);
-                    acc += output_offset;
-                    acc = std::max(acc, output_activation_min);
-                    acc = std::min(acc, output_activation_max);
-                    output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
-                        static_cast<int8_t>(acc);
                 }
             }
         }
-        unsigned my_finish = perf_get_mcycle();
-        my_cycles += (my_finish - my_start);
 
         // printf("convert the result matrix back to output format done. \n");
     }
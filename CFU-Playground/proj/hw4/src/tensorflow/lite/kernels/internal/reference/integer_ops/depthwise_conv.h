@@ -0,0 +1,480 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_DEPTHWISE_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_DEPTHWISE_CONV_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/packed_int8.h"
+#include "tensorflow/lite/kernels/internal/portable_tensor_utils.h"
+
+namespace tflite {
+namespace reference_integer_ops {
+
+// Fast path for depth_multiplier == 1 with a multiple of 4 channels. Input,
+// filter and output are read and written a 32-bit word (4 channels) at a
+// time, so one pass over the window accumulates 4 outputs. The filter taps
+// that land inside the input are found once per output position rather than
+// tested per tap, and a fully interior 3x3 window is unrolled.
+
+// Taps [*start, *end) of one filter dimension land inside [0, size).
+inline void DepthwiseValidTaps(int origin, int dilation, int taps, int size,
+                               int* start, int* end) {
+  int first = 0;
+  while (first < taps && origin + dilation * first < 0) ++first;
+  int last = taps;
+  while (last > first && origin + dilation * (last - 1) >= size) --last;
+  *start = first;
+  *end = last;
+}
+
+// acc[k] += filter[k] * (input[k] + input_offset) for the 4 bytes of a word.
+inline void DepthwiseMac4(uint32_t input_word, uint32_t filter_word,
+                          int32_t input_offset, int32_t* acc) {
+  acc[0] += static_cast<int8_t>(filter_word) *
+            (static_cast<int8_t>(input_word) + input_offset);
+  acc[1] += static_cast<int8_t>(filter_word >> 8) *
+            (static_cast<int8_t>(input_word >> 8) + input_offset);
+  acc[2] += static_cast<int8_t>(filter_word >> 16) *
+            (static_cast<int8_t>(input_word >> 16) + input_offset);
+  acc[3] += static_cast<int8_t>(filter_word >> 24) *
+            (static_cast<int8_t>(input_word >> 24) + input_offset);
+}
+
+// Requantizes 4 accumulators and packs them into one output word.
+inline uint32_t DepthwiseRequantize4(const int32_t* acc,
+                                     const int32_t* output_multiplier,
+                                     const int32_t* output_shift,
+                                     int32_t output_offset,
+                                     int32_t output_activation_min,
+                                     int32_t output_activation_max) {
+  uint32_t word = 0;
+  for (int k = 0; k < 4; ++k) {
+    int32_t value = MultiplyByQuantizedMultiplier(acc[k], output_multiplier[k],
+                                                  output_shift[k]);
+    value += output_offset;
+    value = std::max(value, output_activation_min);
+    value = std::min(value, output_activation_max);
+    word |= static_cast<uint32_t>(static_cast<uint8_t>(value)) << (8 * k);
+  }
+  return word;
+}
+
+inline bool DepthwiseIsWordAligned(const void* p) {
+  return (reinterpret_cast<uintptr_t>(p) & 3) == 0;
+}
+
+inline void DepthwiseConvPerChannelDepth4(
+    const DepthwiseParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+
+  // Strides below are in words.
+  const int depth_words = input_shape.Dims(3) / 4;
+  const int input_row_words = input_width * depth_words;
+  const int filter_row_words = filter_width * depth_words;
+  const int tap_dx = dilation_width_factor * depth_words;
+  const int tap_dy = dilation_height_factor * input_row_words;
+  const bool is_3x3 = filter_height == 3 && filter_width == 3;
+
+  const PackedInt8x4* input_words =
+      reinterpret_cast<const PackedInt8x4*>(input_data);
+  const PackedInt8x4* filter_words =
+      reinterpret_cast<const PackedInt8x4*>(filter_data);
+  PackedInt8x4* output_words = reinterpret_cast<PackedInt8x4*>(output_data);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    const PackedInt8x4* input_batch =
+        input_words + batch * input_height * input_row_words;
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin = (out_y * stride_height) - pad_height;
+      int filter_y_start, filter_y_end;
+      DepthwiseValidTaps(in_y_origin, dilation_height_factor, filter_height,
+                         input_height, &filter_y_start, &filter_y_end);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin = (out_x * stride_width) - pad_width;
+        int filter_x_start, filter_x_end;
+        DepthwiseValidTaps(in_x_origin, dilation_width_factor, filter_width,
+                           input_width, &filter_x_start, &filter_x_end);
+        const bool is_interior = is_3x3 && filter_y_start == 0 &&
+                                 filter_y_end == 3 && filter_x_start == 0 &&
+                                 filter_x_end == 3;
+
+        for (int c = 0; c < depth_words; ++c) {
+          int32_t acc[4] = {0, 0, 0, 0};
+          if (bias_data) {
+            for (int k = 0; k < 4; ++k) acc[k] = bias_data[4 * c + k];
+          }
+          if (is_interior) {
+            const PackedInt8x4* in = input_batch +
+                                     in_y_origin * input_row_words +
+                                     in_x_origin * depth_words + c;
+            const PackedInt8x4* f = filter_words + c;
+            DepthwiseMac4(in[0], f[0], input_offset, acc);
+            DepthwiseMac4(in[tap_dx], f[depth_words], input_offset, acc);
+            DepthwiseMac4(in[2 * tap_dx], f[2 * depth_words], input_offset,
+                          acc);
+            in += tap_dy;
+            f += filter_row_words;
+            DepthwiseMac4(in[0], f[0], input_offset, acc);
+            DepthwiseMac4(in[tap_dx], f[depth_words], input_offset, acc);
+            DepthwiseMac4(in[2 * tap_dx], f[2 * depth_words], input_offset,
+                          acc);
+            in += tap_dy;
+            f += filter_row_words;
+            DepthwiseMac4(in[0], f[0], input_offset, acc);
+            DepthwiseMac4(in[tap_dx], f[depth_words], input_offset, acc);
+            DepthwiseMac4(in[2 * tap_dx], f[2 * depth_words], input_offset,
+                          acc);
+          } else {
+            for (int filter_y = filter_y_start; filter_y < filter_y_end;
+                 ++filter_y) {
+              const int in_y = in_y_origin + dilation_height_factor * filter_y;
+              const PackedInt8x4* in =
+                  input_batch + in_y * input_row_words + c;
+              const PackedInt8x4* f =
+                  filter_words + filter_y * filter_row_words + c;
+              for (int filter_x = filter_x_start; filter_x < filter_x_end;
+                   ++filter_x) {
+                const int in_x = in_x_origin + dilation_width_factor * filter_x;
+                DepthwiseMac4(in[in_x * depth_words], f[filter_x * depth_words],
+                              input_offset, acc);
+              }
+            }
+          }
+          *output_words++ = DepthwiseRequantize4(
+              acc, output_multiplier + 4 * c, output_shift + 4 * c,
+              output_offset, output_activation_min, output_activation_max);
+        }
+      }
+    }
+  }
+}
+
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data) {
+  // Get parameters.
+  // TODO(b/141565753): Re-introduce ScopedProfilingLabel on Micro.
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int depth_multiplier = params.depth_multiplier;
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  // Check dimensions of the tensors.
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  TFLITE_DCHECK_EQ(output_depth, input_depth * depth_multiplier);
+  TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+
+  if (depth_multiplier == 1 && input_depth % 4 == 0 &&
+      DepthwiseIsWordAligned(input_data) &&
+      DepthwiseIsWordAligned(filter_data) &&
+      DepthwiseIsWordAligned(output_data)) {
+    DepthwiseConvPerChannelDepth4(params, output_multiplier, output_shift,
+                                  input_shape, input_data, filter_shape,
+                                  filter_data, bias_data, output_shape,
+                                  output_data);
+    return;
+  }
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+          for (int m = 0; m < depth_multiplier; ++m) {
+            const int output_channel = m + in_channel * depth_multiplier;
+            const int in_x_origin = (out_x * stride_width) - pad_width;
+            const int in_y_origin = (out_y * stride_height) - pad_height;
+            int32_t acc = 0;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                const int in_x = in_x_origin + dilation_width_factor * filter_x;
+                const int in_y =
+                    in_y_origin + dilation_height_factor * filter_y;
+                // Zero padding by omitting the areas outside the image.
+                const bool is_point_inside_image =
+                    (in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                    (in_y < input_height);
+                if (is_point_inside_image) {
+                  int32_t input_val = input_data[Offset(
+                      input_shape, batch, in_y, in_x, in_channel)];
+                  int32_t filter_val = filter_data[Offset(
+                      filter_shape, 0, filter_y, filter_x, output_channel)];
+                  // Accumulate with 32 bits accumulator.
+                  // In the nudging process during model quantization, we force
+                  // real value of 0.0 be represented by a quantized value. This
+                  // guarantees that the input_offset is a int8_t, even though
+                  // it is represented using int32_t. int32_t += int8_t *
+                  // (int8_t - int8_t) so the highest value we can get from each
+                  // accumulation is [-127, 127] * ([-128, 127] -
+                  // [-128, 127]), which is [-32512, 32512]. log2(32512)
+                  // = 14.98, which means we can accumulate at least 2^16
+                  // multiplications without overflow. The accumulator is
+                  // applied to a filter so the accumulation logic will hold as
+                  // long as the filter size (filter_y * filter_x * in_channel)
+                  // does not exceed 2^16, which is the case in all the models
+                  // we have seen so far.
+                  // TODO(b/174275578): Add a check to make sure the
+                  // accumulator depth is smaller than 2^16.
+                  acc += filter_val * (input_val + input_offset);
+                }
+              }
+            }
+            if (bias_data) {
+              acc += bias_data[output_channel];
+            }
+            acc = MultiplyByQuantizedMultiplier(
+                acc, output_multiplier[output_channel],
+                output_shift[output_channel]);
+            acc += output_offset;
+            acc = std::max(acc, output_activation_min);
+            acc = std::min(acc, output_activation_max);
+            output_data[Offset(output_shape, batch, out_y, out_x,
+                               output_channel)] = static_cast<int8_t>(acc);
+          }
+        }
+      }
+    }
+  }
+}
+
+inline void DepthwiseConvPerChannelWithPackedInt4Weights(
+    const DepthwiseParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, int8_t* unpacked_filter_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data) {
+  TFLITE_DCHECK_NE(unpacked_filter_data, nullptr);
+  tflite::tensor_utils::UnpackDenseInt4IntoInt8(
+      filter_data, filter_shape.FlatSize(), unpacked_filter_data);
+  DepthwiseConvPerChannel(params, output_multiplier, output_shift, input_shape,
+                          input_data, filter_shape, unpacked_filter_data,
+                          bias_shape, bias_data, output_shape, output_data);
+}
+
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int16_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const std::int64_t* bias_data, const RuntimeShape& output_shape,
+    int16_t* output_data) {
+  // Get parameters.
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int depth_multiplier = params.depth_multiplier;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  // Check dimensions of the tensors.
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  TFLITE_DCHECK_EQ(output_depth, input_depth * depth_multiplier);
+  TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+          for (int m = 0; m < depth_multiplier; ++m) {
+            const int output_channel = m + in_channel * depth_multiplier;
+            const int in_x_origin = (out_x * stride_width) - pad_width;
+            const int in_y_origin = (out_y * stride_height) - pad_height;
+            std::int64_t acc = 0;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                const int in_x = in_x_origin + dilation_width_factor * filter_x;
+                const int in_y =
+                    in_y_origin + dilation_height_factor * filter_y;
+                // Zero padding by omitting the areas outside the image.
+                const bool is_point_inside_image =
+                    (in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                    (in_y < input_height);
+                if (is_point_inside_image) {
+                  int32_t input_val = input_data[Offset(
+                      input_shape, batch, in_y, in_x, in_channel)];
+                  int32_t filter_val = filter_data[Offset(
+                      filter_shape, 0, filter_y, filter_x, output_channel)];
+                  // Accumulate with 64 bits accumulator.
+                  // We assume maximum of 2^16 accumulations as with the 8-bit
+                  // case so actually the value in the accumulator should not
+                  // exceed 40 bits
+                  acc += static_cast<int64_t>(filter_val) *
+                         static_cast<int64_t>(input_val);
+                }
+              }
+            }
+            if (bias_data) {
+              acc += bias_data[output_channel];
+            }
+            int32_t scaled_acc = MultiplyByQuantizedMultiplier(
+                acc, output_multiplier[output_channel],
+                output_shift[output_channel]);
+            scaled_acc = std::max(scaled_acc, output_activation_min);
+            scaled_acc = std::min(scaled_acc, output_activation_max);
+            output_data[Offset(output_shape, batch, out_y, out_x,
+                               output_channel)] =
+                static_cast<int16_t>(scaled_acc);
+          }
+        }
+      }
+    }
+  }
+}
+
+inline void DepthwiseConvHybridPerChannel(
+    const DepthwiseParams& params, float* scaling_factors_ptr,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& filter_shape, const int8_t* filter_data,
+    const RuntimeShape& bias_shape, const float* bias_data,
+    const RuntimeShape& output_shape, float* output_data,
+    const float* per_channel_scale, int32_t* input_offset) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int dilation_width_factor = params.dilation_width_factor;
+  const int dilation_height_factor = params.dilation_height_factor;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int depth_multiplier = params.depth_multiplier;
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  // Check dimensions of the tensors.
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int output_depth = MatchingDim(filter_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int bias_depth = bias_shape.FlatSize();
+  TFLITE_DCHECK_EQ(output_depth, input_depth * depth_multiplier);
+  TFLITE_DCHECK_EQ(bias_depth, output_depth);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+          for (int m = 0; m < depth_multiplier; ++m) {
+            const int output_channel = m + in_channel * depth_multiplier;
+            const int in_x_origin = (out_x * stride_width) - pad_width;
+            const int in_y_origin = (out_y * stride_height) - pad_height;
+            int32_t acc = 0;
+            for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+              for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+                const int in_x = in_x_origin + dilation_width_factor * filter_x;
+                const int in_y =
+                    in_y_origin + dilation_height_factor * filter_y;
+                // Zero padding by omitting the areas outside the image.
+                const bool is_point_inside_image =
+                    (in_x >= 0) && (in_x < input_width) && (in_y >= 0) &&
+                    (in_y < input_height);
+                if (is_point_inside_image) {
+                  int32_t input_val = input_data[Offset(
+                      input_shape, batch, in_y, in_x, in_channel)];
+                  int32_t filter_val = filter_data[Offset(
+                      filter_shape, 0, filter_y, filter_x, output_channel)];
+                  acc += filter_val * (input_val - input_offset[batch]);
+                }
+              }
+            }
+            float acc_float = static_cast<float>(acc);
+            acc_float *=
+                per_channel_scale[output_channel] * scaling_factors_ptr[batch];
+            if (bias_data && output_channel < bias_depth) {
+              acc_float += bias_data[output_channel];
+            }
+            output_data[Offset(output_shape, batch, out_y, out_x,
+                               output_channel)] =
+                ActivationFunctionWithMinMax(acc_float, output_activation_min,
+                                             output_activation_max);
+          }
+        }
+      }
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_DEPTHWISE_CONV_H_
@@ -18,7 +18,9 @@ limitations under the License.
 #include <algorithm>
 
 #include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/packed_int8.h"
 #include "tensorflow/lite/kernels/internal/portable_tensor_utils.h"
+#include "simd_cfu.h"
 
 namespace tflite {
 namespace reference_integer_ops {
@@ -154,6 +156,221 @@ inline void FullyConnected(
   }
 }
 
+// Blocked int8 kernel on the SIMD MAC unit (simd_cfu.h). The input offset
+// is folded into the bias once, at prepare time:
+//   folded_bias[o] = bias[o] + input_offset * sum_d filter[o][d]
+// so the inner loop is a plain int8 dot product. Four output rows are
+// computed per pass over the input: each input word is loaded once and
+// multiplied with the matching word of four filter rows, one CFU
+// accumulator per row. Filter zero point must be 0.
+
+inline void FullyConnectedFoldBias(int32_t input_offset,
+                                   const int8_t* filter_data,
+                                   const int32_t* bias_data, int output_depth,
+                                   int accum_depth, int32_t* folded_bias) {
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    int32_t filter_sum = 0;
+    for (int d = 0; d < accum_depth; ++d) {
+      filter_sum += filter_data[out_c * accum_depth + d];
+    }
+    folded_bias[out_c] =
+        (bias_data ? bias_data[out_c] : 0) + input_offset * filter_sum;
+  }
+}
+
+// The blocked kernel reads whole words, so rows must be word aligned.
+inline bool FullyConnectedCanBlock(const RuntimeShape& filter_shape,
+                                   const int8_t* input_data,
+                                   const int8_t* filter_data) {
+  const int accum_depth = filter_shape.Dims(filter_shape.DimensionsCount() - 1);
+  return accum_depth % 4 == 0 &&
+         (reinterpret_cast<uintptr_t>(input_data) & 3) == 0 &&
+         (reinterpret_cast<uintptr_t>(filter_data) & 3) == 0;
+}
+
+inline int8_t FullyConnectedRequantize(int32_t acc, int32_t output_multiplier,
+                                       int output_shift, int32_t output_offset,
+                                       int32_t output_activation_min,
+                                       int32_t output_activation_max) {
+  acc = MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+  acc += output_offset;
+  acc = std::max(acc, output_activation_min);
+  acc = std::min(acc, output_activation_max);
+  return static_cast<int8_t>(acc);
+}
+
+// acc[k] = folded_bias[k * bias_stride] + dot(in, row k) for the four filter
+// rows starting at w0, row_stride_words apart. Each input word is loaded
+// once for all four rows. Also used by the blocked TransposeConv.
+inline void FullyConnectedFourRows(const PackedInt8x4* in,
+                                   const PackedInt8x4* w0,
+                                   int row_stride_words, int depth_words,
+                                   const int32_t* folded_bias, int bias_stride,
+                                   int32_t* acc) {
+  const PackedInt8x4* w1 = w0 + row_stride_words;
+  const PackedInt8x4* w2 = w1 + row_stride_words;
+  const PackedInt8x4* w3 = w2 + row_stride_words;
+  int32_t acc0 = simd_cfu_set_acc(0, folded_bias[0]);
+  int32_t acc1 = simd_cfu_set_acc(1, folded_bias[bias_stride]);
+  int32_t acc2 = simd_cfu_set_acc(2, folded_bias[2 * bias_stride]);
+  int32_t acc3 = simd_cfu_set_acc(3, folded_bias[3 * bias_stride]);
+  for (int d = 0; d < depth_words; ++d) {
+    const uint32_t input_word = in[d];
+    acc0 = simd_cfu_mac(0, input_word, w0[d]);
+    acc1 = simd_cfu_mac(1, input_word, w1[d]);
+    acc2 = simd_cfu_mac(2, input_word, w2[d]);
+    acc3 = simd_cfu_mac(3, input_word, w3[d]);
+  }
+  acc[0] = acc0;
+  acc[1] = acc1;
+  acc[2] = acc2;
+  acc[3] = acc3;
+}
+
+// folded_bias + dot(in, w) on accumulator 0.
+inline int32_t FullyConnectedOneRow(const PackedInt8x4* in,
+                                    const PackedInt8x4* w, int depth_words,
+                                    int32_t folded_bias) {
+  int32_t acc = simd_cfu_set_acc(0, folded_bias);
+  for (int d = 0; d < depth_words; ++d) {
+    acc = simd_cfu_mac(0, in[d], w[d]);
+  }
+  return acc;
+}
+
+// Multiplies one filter row with kRows consecutive batch rows of the input,
+// one CFU accumulator per batch row, so each weight word is loaded once for
+// all of them.
+template <int kRows>
+inline void FullyConnectedRowTimesBatches(const PackedInt8x4* filter_row,
+                                          const PackedInt8x4* in,
+                                          int depth_words, int32_t folded_bias,
+                                          int32_t* acc) {
+  acc[0] = simd_cfu_set_acc(0, folded_bias);
+  if (kRows > 1) acc[1] = simd_cfu_set_acc(1, folded_bias);
+  if (kRows > 2) acc[2] = simd_cfu_set_acc(2, folded_bias);
+  if (kRows > 3) acc[3] = simd_cfu_set_acc(3, folded_bias);
+  for (int d = 0; d < depth_words; ++d) {
+    const uint32_t filter_word = filter_row[d];
+    acc[0] = simd_cfu_mac(0, in[d], filter_word);
+    if (kRows > 1) acc[1] = simd_cfu_mac(1, in[depth_words + d], filter_word);
+    if (kRows > 2) {
+      acc[2] = simd_cfu_mac(2, in[2 * depth_words + d], filter_word);
+    }
+    if (kRows > 3) {
+      acc[3] = simd_cfu_mac(3, in[3 * depth_words + d], filter_word);
+    }
+  }
+}
+
+// Batched GEMV: weight-stationary over up to 4 batch rows at a time, so the
+// weight matrix is streamed once per 4 batch rows instead of once per row.
+inline void FullyConnectedBlockedBatches(
+    const FullyConnectedParams& params, const int32_t* folded_bias,
+    const int32_t* output_multiplier, const int* output_shift,
+    bool per_channel, int batches, int output_depth, int depth_words,
+    const int8_t* input_data, const int8_t* filter_data,
+    int8_t* output_data) {
+  const PackedInt8x4* input_words =
+      reinterpret_cast<const PackedInt8x4*>(input_data);
+  const PackedInt8x4* filter_words =
+      reinterpret_cast<const PackedInt8x4*>(filter_data);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    const PackedInt8x4* filter_row = filter_words + out_c * depth_words;
+    const int q = per_channel ? out_c : 0;
+    for (int b = 0; b < batches; b += 4) {
+      const PackedInt8x4* in = input_words + b * depth_words;
+      const int rows = std::min(batches - b, 4);
+      int32_t acc[4];
+      switch (rows) {
+        case 4:
+          FullyConnectedRowTimesBatches<4>(filter_row, in, depth_words,
+                                           folded_bias[out_c], acc);
+          break;
+        case 3:
+          FullyConnectedRowTimesBatches<3>(filter_row, in, depth_words,
+                                           folded_bias[out_c], acc);
+          break;
+        case 2:
+          FullyConnectedRowTimesBatches<2>(filter_row, in, depth_words,
+                                           folded_bias[out_c], acc);
+          break;
+        default:
+          FullyConnectedRowTimesBatches<1>(filter_row, in, depth_words,
+                                           folded_bias[out_c], acc);
+          break;
+      }
+      for (int k = 0; k < rows; ++k) {
+        output_data[(b + k) * output_depth + out_c] = FullyConnectedRequantize(
+            acc[k], output_multiplier[q], output_shift[q],
+            params.output_offset, params.quantized_activation_min,
+            params.quantized_activation_max);
+      }
+    }
+  }
+}
+
+// Per-tensor kernels pass a single multiplier and shift with per_channel
+// false.
+inline void FullyConnectedBlocked(
+    const FullyConnectedParams& params, const int32_t* folded_bias,
+    const int32_t* output_multiplier, const int* output_shift,
+    bool per_channel, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& output_shape,
+    int8_t* output_data) {
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_GE(filter_shape.DimensionsCount(), 2);
+  TFLITE_DCHECK_GE(output_shape.DimensionsCount(), 1);
+
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+  const int filter_dim_count = filter_shape.DimensionsCount();
+  const int output_dim_count = output_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dim_count - 1);
+  const int output_depth = output_shape.Dims(output_dim_count - 1);
+  TFLITE_DCHECK_LE(output_depth, filter_shape.Dims(filter_dim_count - 2));
+  const int accum_depth = filter_shape.Dims(filter_dim_count - 1);
+  TFLITE_DCHECK_EQ(accum_depth % 4, 0);
+  const int depth_words = accum_depth / 4;
+  const PackedInt8x4* filter_words =
+      reinterpret_cast<const PackedInt8x4*>(filter_data);
+
+  if (batches > 1) {
+    FullyConnectedBlockedBatches(params, folded_bias, output_multiplier,
+                                 output_shift, per_channel, batches,
+                                 output_depth, depth_words, input_data,
+                                 filter_data, output_data);
+    return;
+  }
+
+  TFLITE_DCHECK_EQ(batches, 1);
+  const PackedInt8x4* in = reinterpret_cast<const PackedInt8x4*>(input_data);
+  int out_c = 0;
+  for (; out_c + 4 <= output_depth; out_c += 4) {
+    int32_t acc[4];
+    FullyConnectedFourRows(in, filter_words + out_c * depth_words,
+                           depth_words, depth_words, folded_bias + out_c, 1,
+                           acc);
+    for (int k = 0; k < 4; ++k) {
+      const int q = per_channel ? out_c + k : 0;
+      output_data[out_c + k] = FullyConnectedRequantize(
+          acc[k], output_multiplier[q], output_shift[q], output_offset,
+          output_activation_min, output_activation_max);
+    }
+  }
+  for (; out_c < output_depth; ++out_c) {
+    const int32_t acc =
+        FullyConnectedOneRow(in, filter_words + out_c * depth_words,
+                             depth_words, folded_bias[out_c]);
+    const int q = per_channel ? out_c : 0;
+    output_data[out_c] = FullyConnectedRequantize(
+        acc, output_multiplier[q], output_shift[q], output_offset,
+        output_activation_min, output_activation_max);
+  }
+}
+
 inline void FullyConnectedWithPackedInt4Weights(
     const FullyConnectedParams& params, const RuntimeShape& input_shape,
     const int8_t* input_data, const RuntimeShape& filter_shape,
@@ -0,0 +1,158 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_MEAN_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_MEAN_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/packed_int8.h"
+
+namespace tflite {
+namespace reference_integer_ops {
+
+template <typename integer_type>
+inline void Mean(const tflite::MeanParams& op_params, int32_t multiplier,
+                 int32_t shift, const RuntimeShape& unextended_input_shape,
+                 const integer_type* input_data, int32_t input_zero_point,
+                 const RuntimeShape& unextended_output_shape,
+                 integer_type* output_data, int32_t output_zero_point) {
+  // Current implementation only supports dimension equals 4 and simultaneous
+  // reduction over width and height.
+  TFLITE_CHECK_EQ(unextended_input_shape.DimensionsCount(), 4);
+  TFLITE_CHECK_LE(unextended_output_shape.DimensionsCount(), 4);
+  const RuntimeShape input_shape =
+      RuntimeShape::ExtendedShape(4, unextended_input_shape);
+  const RuntimeShape output_shape =
+      RuntimeShape::ExtendedShape(4, unextended_output_shape);
+  const int output_batch = output_shape.Dims(0);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int num_elements_in_axis = input_width * input_height;
+
+  TFLITE_CHECK_EQ(op_params.axis_count, 2);
+  TFLITE_CHECK((op_params.axis[0] == 1 && op_params.axis[1] == 2) ||
+               (op_params.axis[0] == 2 && op_params.axis[1] == 1));
+  TFLITE_CHECK_EQ(output_height, 1);
+  TFLITE_CHECK_EQ(output_width, 1);
+
+  static constexpr int32_t kMinInt = std::numeric_limits<integer_type>::min();
+  static constexpr int32_t kMaxInt = std::numeric_limits<integer_type>::max();
+
+  for (int out_b = 0; out_b < output_batch; ++out_b) {
+    for (int out_d = 0; out_d < output_depth; ++out_d) {
+      int32_t acc = 0;
+      for (int in_h = 0; in_h < input_height; ++in_h) {
+        for (int in_w = 0; in_w < input_width; ++in_w) {
+          acc += input_data[Offset(input_shape, out_b, in_h, in_w, out_d)] -
+                 input_zero_point;
+        }
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, multiplier, shift);
+      acc = acc > 0 ? (acc + num_elements_in_axis / 2) / num_elements_in_axis
+                    : (acc - num_elements_in_axis / 2) / num_elements_in_axis;
+      acc += output_zero_point;
+      acc = std::min(std::max(acc, kMinInt), kMaxInt);
+      output_data[Offset(output_shape, out_b, 0, 0, out_d)] =
+          static_cast<integer_type>(acc);
+    }
+  }
+}
+
+// Pixels whose biased (x + 128) bytes can be summed into a 16-bit lane:
+// 257 * 255 = 65535.
+constexpr int kMeanPackedMaxPixels = 257;
+
+// Sums four consecutive channels over num_pixels pixels spaced stride bytes
+// apart. Each word load covers the four channels. The bytes are biased to
+// unsigned and added two lanes at a time into 16-bit halves of two words,
+// which are flushed into 32-bit sums every kMeanPackedMaxPixels pixels.
+// input and stride must be multiples of 4 bytes. Returns sum(x + 128).
+inline void MeanSumChannels4(const int8_t* input, int num_pixels, int stride,
+                             int32_t* sums) {
+  sums[0] = sums[1] = sums[2] = sums[3] = 0;
+  for (int p = 0; p < num_pixels; p += kMeanPackedMaxPixels) {
+    const int chunk = std::min(num_pixels - p, kMeanPackedMaxPixels);
+    uint32_t even = 0;  // Channels 0 and 2.
+    uint32_t odd = 0;   // Channels 1 and 3.
+    for (int i = 0; i < chunk; ++i) {
+      const uint32_t word =
+          *reinterpret_cast<const PackedInt8x4*>(input) ^ 0x80808080;
+      even += word & 0x00ff00ff;
+      odd += (word >> 8) & 0x00ff00ff;
+      input += stride;
+    }
+    sums[0] += even & 0xffff;
+    sums[1] += odd & 0xffff;
+    sums[2] += even >> 16;
+    sums[3] += odd >> 16;
+  }
+}
+
+// Mean of an NHWC int8 tensor over axes 1 and 2, one output per batch and
+// channel. multiplier and shift quantize
+// input_scale / (output_scale * height * width), so each output takes one
+// rounding multiply.
+inline void MeanOverHeightWidth(int32_t multiplier, int shift,
+                                const RuntimeShape& input_shape,
+                                const int8_t* input_data,
+                                int32_t input_zero_point, int8_t* output_data,
+                                int32_t output_zero_point) {
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  const int batches = input_shape.Dims(0);
+  const int num_pixels = input_shape.Dims(1) * input_shape.Dims(2);
+  const int depth = input_shape.Dims(3);
+  // Removes the +128 bias and the input zero point from every sum.
+  const int32_t offset = num_pixels * (128 + input_zero_point);
+  const bool words = depth % 4 == 0 &&
+                     (reinterpret_cast<uintptr_t>(input_data) & 3) == 0;
+
+  for (int b = 0; b < batches; ++b) {
+    const int8_t* input = input_data + b * num_pixels * depth;
+    int8_t* output = output_data + b * depth;
+    for (int c = 0; c < depth; c += 4) {
+      const int channels = std::min(depth - c, 4);
+      int32_t sums[4];
+      if (words) {
+        MeanSumChannels4(input + c, num_pixels, depth, sums);
+      } else {
+        for (int k = 0; k < channels; ++k) {
+          int32_t sum = 0;
+          const int8_t* in = input + c + k;
+          for (int i = 0; i < num_pixels; ++i, in += depth) {
+            sum += *in + 128;
+          }
+          sums[k] = sum;
+        }
+      }
+      for (int k = 0; k < channels; ++k) {
+        int32_t acc = MultiplyByQuantizedMultiplier(sums[k] - offset,
+                                                    multiplier, shift);
+        acc += output_zero_point;
+        acc = std::min(std::max(acc, static_cast<int32_t>(-128)),
+                       static_cast<int32_t>(127));
+        output[c + k] = static_cast<int8_t>(acc);
+      }
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_MEAN_H_
@@ -0,0 +1,352 @@
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_POOLING_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_POOLING_H_
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+
+namespace tflite {
+namespace reference_integer_ops {
+
+// Divides by a window size n with a multiply instead of a divide, which is
+// emulated on some of our cores. m = ceil(2^32 / n) gives the exact quotient
+// floor(x / n) as the high word of x * m whenever x * (n - 1) < 2^32.
+struct PoolDivisor {
+  int32_t n;
+  uint32_t m;
+};
+
+inline void SetPoolDivisor(int32_t n, PoolDivisor* divisor) {
+  divisor->n = n;
+  divisor->m = n > 1 ? 0xffffffffu / static_cast<uint32_t>(n) + 1 : 0;
+}
+
+// Average pool windows hold at most kMaxPoolReciprocalCount elements, so
+// |sum| + n / 2 < 129 * n and the reciprocal is exact.
+constexpr int32_t kMaxPoolReciprocalCount = 4096;
+
+// sum / n rounded half away from zero, as the reference kernel does with
+// (sum +- n / 2) / n.
+inline int32_t PoolRoundedDivide(int32_t sum, const PoolDivisor& divisor) {
+  const int32_t n = divisor.n;
+  const uint32_t magnitude =
+      static_cast<uint32_t>(sum > 0 ? sum : -sum) + n / 2;
+  uint32_t quotient;
+  if (n == 1) {
+    quotient = magnitude;
+  } else if (n <= kMaxPoolReciprocalCount) {
+    quotient = (static_cast<uint64_t>(magnitude) * divisor.m) >> 32;
+  } else {
+    quotient = magnitude / n;
+  }
+  return sum > 0 ? static_cast<int32_t>(quotient)
+                 : -static_cast<int32_t>(quotient);
+}
+
+inline int8_t PoolClamp(int32_t value, const PoolParams& params) {
+  value = std::max(value, params.quantized_activation_min);
+  value = std::min(value, params.quantized_activation_max);
+  return static_cast<int8_t>(value);
+}
+
+// One window covering the whole (unpadded) input: a single reduction per
+// channel with one reciprocal.
+inline void GlobalAveragePool(const PoolParams& params, int batches,
+                              int positions, int depth,
+                              const int8_t* input_data, int8_t* output_data) {
+  PoolDivisor divisor;
+  SetPoolDivisor(positions, &divisor);
+  for (int batch = 0; batch < batches; ++batch) {
+    const int8_t* input = input_data + batch * positions * depth;
+    for (int channel = 0; channel < depth; ++channel) {
+      int32_t sum = 0;
+      for (int i = 0; i < positions; ++i) {
+        sum += input[i * depth + channel];
+      }
+      output_data[batch * depth + channel] =
+          PoolClamp(PoolRoundedDivide(sum, divisor), params);
+    }
+  }
+}
+
+// Average pool with a sliding window along x. For each output row and
+// channel the window sum is updated column by column: a column (the sum of
+// the window's input rows at one x) is added when it enters the window and
+// subtracted when it leaves, so each input column is summed at most twice
+// per output row whatever the filter width.
+inline bool AveragePool(const PoolParams& params,
+                        const RuntimeShape& input_shape,
+                        const int8_t* input_data,
+                        const RuntimeShape& output_shape, int8_t* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+  const int input_row_size = input_width * depth;
+
+  if (output_height == 1 && output_width == 1 &&
+      params.padding_values.height == 0 && params.padding_values.width == 0 &&
+      params.filter_height >= input_height &&
+      params.filter_width >= input_width) {
+    GlobalAveragePool(params, batches, input_height * input_width, depth,
+                      input_data, output_data);
+    return true;
+  }
+
+  PoolDivisor divisor = {0, 0};
+  for (int batch = 0; batch < batches; ++batch) {
+    const int8_t* input = input_data + batch * input_height * input_row_size;
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          (out_y * stride_height) - params.padding_values.height;
+      const int in_y_start = std::max(0, in_y_origin);
+      const int in_y_end =
+          std::min(input_height, in_y_origin + params.filter_height);
+      if (in_y_end <= in_y_start) return false;
+      int8_t* output =
+          output_data + ((batch * output_height + out_y) * output_width) * depth;
+      for (int channel = 0; channel < depth; ++channel) {
+        const int8_t* column_top = input + in_y_start * input_row_size + channel;
+        // The window covers input columns [x_start, x_end).
+        int x_start = 0;
+        int x_end = 0;
+        int32_t sum = 0;
+        for (int out_x = 0; out_x < output_width; ++out_x) {
+          const int in_x_origin =
+              (out_x * stride_width) - params.padding_values.width;
+          const int new_start = std::max(0, in_x_origin);
+          const int new_end =
+              std::min(input_width, in_x_origin + params.filter_width);
+          if (new_end <= new_start) return false;
+          if (new_start >= x_end) {
+            // No overlap with the previous window.
+            sum = 0;
+            x_start = x_end = new_start;
+          }
+          for (; x_start < new_start; ++x_start) {
+            const int8_t* p = column_top + x_start * depth;
+            for (int y = in_y_start; y < in_y_end; ++y, p += input_row_size) {
+              sum -= *p;
+            }
+          }
+          for (; x_end < new_end; ++x_end) {
+            const int8_t* p = column_top + x_end * depth;
+            for (int y = in_y_start; y < in_y_end; ++y, p += input_row_size) {
+              sum += *p;
+            }
+          }
+          const int32_t filter_count =
+              (in_y_end - in_y_start) * (x_end - x_start);
+          if (filter_count != divisor.n) SetPoolDivisor(filter_count, &divisor);
+          output[out_x * depth + channel] =
+              PoolClamp(PoolRoundedDivide(sum, divisor), params);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// Max pool with the window clipped once per output position and the input
+// walked with pointer strides; channels are innermost so each window row is
+// a contiguous run of the input.
+inline void MaxPool(const PoolParams& params, const RuntimeShape& input_shape,
+                    const int8_t* input_data, const RuntimeShape& output_shape,
+                    int8_t* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_GE(params.quantized_activation_min,
+                   std::numeric_limits<int8_t>::min());
+  TFLITE_DCHECK_LE(params.quantized_activation_max,
+                   std::numeric_limits<int8_t>::max());
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+  const int input_row_size = input_width * depth;
+  int8_t* output = output_data;
+  for (int batch = 0; batch < batches; ++batch) {
+    const int8_t* input = input_data + batch * input_height * input_row_size;
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      const int in_y_origin =
+          (out_y * stride_height) - params.padding_values.height;
+      const int in_y_start = std::max(0, in_y_origin);
+      const int in_y_end =
+          std::min(input_height, in_y_origin + params.filter_height);
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        const int in_x_origin =
+            (out_x * stride_width) - params.padding_values.width;
+        const int in_x_start = std::max(0, in_x_origin);
+        const int in_x_end =
+            std::min(input_width, in_x_origin + params.filter_width);
+        for (int channel = 0; channel < depth; ++channel) {
+          output[channel] = std::numeric_limits<int8_t>::lowest();
+        }
+        for (int y = in_y_start; y < in_y_end; ++y) {
+          const int8_t* p = input + y * input_row_size + in_x_start * depth;
+          for (int x = in_x_start; x < in_x_end; ++x, p += depth) {
+            for (int channel = 0; channel < depth; ++channel) {
+              output[channel] = std::max(output[channel], p[channel]);
+            }
+          }
+        }
+        for (int channel = 0; channel < depth; ++channel) {
+          output[channel] = PoolClamp(output[channel], params);
+        }
+        output += depth;
+      }
+    }
+  }
+}
+
+inline bool AveragePool(const PoolParams& params,
+                        const RuntimeShape& input_shape,
+                        const int16_t* input_data,
+                        const RuntimeShape& output_shape,
+                        int16_t* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int channel = 0; channel < depth; ++channel) {
+          const int in_x_origin =
+              (out_x * stride_width) - params.padding_values.width;
+          const int in_y_origin =
+              (out_y * stride_height) - params.padding_values.height;
+          // Compute the boundaries of the filter region clamped so as to
+          // ensure that the filter window fits in the input array.
+          const int filter_x_start = std::max(0, -in_x_origin);
+          const int filter_x_end =
+              std::min(params.filter_width, input_width - in_x_origin);
+          const int filter_y_start = std::max(0, -in_y_origin);
+          const int filter_y_end =
+              std::min(params.filter_height, input_height - in_y_origin);
+          int32_t acc = 0;
+          int filter_count = 0;
+          for (int filter_y = filter_y_start; filter_y < filter_y_end;
+               ++filter_y) {
+            for (int filter_x = filter_x_start; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int in_x = in_x_origin + filter_x;
+              const int in_y = in_y_origin + filter_y;
+              acc +=
+                  input_data[Offset(input_shape, batch, in_y, in_x, channel)];
+              filter_count++;
+            }
+          }
+          if (filter_count == 0) return false;
+          // Round to the closest integer value.
+          acc = acc > 0 ? (acc + filter_count / 2) / filter_count
+                        : (acc - filter_count / 2) / filter_count;
+          acc = std::max(acc, params.quantized_activation_min);
+          acc = std::min(acc, params.quantized_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, channel)] =
+              static_cast<int16_t>(acc);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+inline void MaxPool(const PoolParams& params, const RuntimeShape& input_shape,
+                    const int16_t* input_data, const RuntimeShape& output_shape,
+                    int16_t* output_data) {
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  TFLITE_DCHECK_GE(params.quantized_activation_min,
+                   std::numeric_limits<int16_t>::min());
+  TFLITE_DCHECK_LE(params.quantized_activation_max,
+                   std::numeric_limits<int16_t>::max());
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int depth = MatchingDim(input_shape, 3, output_shape, 3);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int stride_height = params.stride_height;
+  const int stride_width = params.stride_width;
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int channel = 0; channel < depth; ++channel) {
+          const int in_x_origin =
+              (out_x * stride_width) - params.padding_values.width;
+          const int in_y_origin =
+              (out_y * stride_height) - params.padding_values.height;
+          // Compute the boundaries of the filter region clamped so as to
+          // ensure that the filter window fits in the input array.
+          const int filter_x_start = std::max(0, -in_x_origin);
+          const int filter_x_end =
+              std::min(params.filter_width, input_width - in_x_origin);
+          const int filter_y_start = std::max(0, -in_y_origin);
+          const int filter_y_end =
+              std::min(params.filter_height, input_height - in_y_origin);
+          int16_t max = std::numeric_limits<int16_t>::lowest();
+          for (int filter_y = filter_y_start; filter_y < filter_y_end;
+               ++filter_y) {
+            for (int filter_x = filter_x_start; filter_x < filter_x_end;
+                 ++filter_x) {
+              const int in_x = in_x_origin + filter_x;
+              const int in_y = in_y_origin + filter_y;
+              max = std::max(
+                  max,
+                  input_data[Offset(input_shape, batch, in_y, in_x, channel)]);
+            }
+          }
+          max = std::max<int16_t>(max, params.quantized_activation_min);
+          max = std::min<int16_t>(max, params.quantized_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, channel)] =
+              static_cast<int16_t>(max);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_POOLING_H_
@@ -0,0 +1,417 @@
+/* Copyright 2019 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_TRANSPOSE_CONV_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_TRANSPOSE_CONV_H_
+
+#include <algorithm>
+
+#include "tensorflow/lite/kernels/internal/common.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/fully_connected.h"
+
+namespace tflite {
+namespace reference_integer_ops {
+
+// Fixed-point per-channel-quantization transpose convolution reference kernel.
+inline void TransposeConv(
+    const ConvParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int8_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const int32_t* bias_data, const RuntimeShape& output_shape,
+    int8_t* output_data, const RuntimeShape& im2col_shape, int8_t* im2col_data,
+    int32_t* scratch_buffer) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  (void)im2col_data;   // only used in optimized code.
+  (void)im2col_shape;  // only used in optimized code.
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+
+  const int num_elements = output_shape.FlatSize();
+  // We need to initialize scratch_buffer to all 0s, as we apply the same
+  // 'scatter' based trick as in float version.
+  memset(scratch_buffer, 0, num_elements * sizeof(int32_t));
+
+  // Loop through input elements one at a time.
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int in_y = 0; in_y < input_height; ++in_y) {
+      for (int in_x = 0; in_x < input_width; ++in_x) {
+        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+          // Loop through the output elements it will influence.
+          const int out_x_origin = (in_x * stride_width) - pad_width;
+          const int out_y_origin = (in_y * stride_height) - pad_height;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              for (int out_channel = 0; out_channel < output_depth;
+                   ++out_channel) {
+                // Compute output element location.
+                const int out_x = out_x_origin + filter_x;
+                const int out_y = out_y_origin + filter_y;
+                // We cannot accumulate out of bounds.
+                if ((out_x >= 0) && (out_x < output_width) && (out_y >= 0) &&
+                    (out_y < output_height)) {
+                  const int8_t input_value = input_data[Offset(
+                      input_shape, batch, in_y, in_x, in_channel)];
+                  const int8_t filter_value =
+                      filter_data[Offset(filter_shape, out_channel, filter_y,
+                                         filter_x, in_channel)];
+                  scratch_buffer[Offset(output_shape, batch, out_y, out_x,
+                                        out_channel)] +=
+                      (input_value + input_offset) * filter_value;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          int32_t acc = scratch_buffer[Offset(output_shape, batch, out_y, out_x,
+                                              out_channel)];
+          if (bias_data) {
+            acc += bias_data[out_channel];
+          }
+          acc = MultiplyByQuantizedMultiplier(
+              acc, output_multiplier[out_channel], output_shift[out_channel]);
+          acc += output_offset;
+          acc = std::max(acc, output_activation_min);
+          acc = std::min(acc, output_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
+              static_cast<int8_t>(acc);
+        }
+      }
+    }
+  }
+}
+
+// GEMM form of the int8 kernel above on the SIMD MAC unit. With the filter
+// viewed as a matrix of output_depth * filter_height * filter_width rows of
+// input_depth, each input pixel times the filter gives one column of
+// partial sums per filter tap, which is scatter-added (col2im) into the
+// int32 scratch buffer. Taps that land outside the output are skipped.
+// Rows go through the FC engine four output channels at a time.
+//
+// folded_filter_sums holds input_offset * sum(row) for every filter row, in
+// filter order (see FullyConnectedFoldBias with no bias). The bias is added
+// once per output, at requantization.
+
+// The blocked kernel reads whole words, so input pixels and filter rows must
+// be word aligned.
+inline bool TransposeConvCanBlock(const RuntimeShape& input_shape,
+                                  const int8_t* input_data,
+                                  const int8_t* filter_data) {
+  return input_shape.Dims(3) % 4 == 0 &&
+         (reinterpret_cast<uintptr_t>(input_data) & 3) == 0 &&
+         (reinterpret_cast<uintptr_t>(filter_data) & 3) == 0;
+}
+
+// Partial sums of one input pixel for one filter tap, all output channels.
+// taps is filter_height * filter_width and tap indexes the filter rows.
+inline void TransposeConvTapColumn(const PackedInt8x4* in,
+                                   const PackedInt8x4* filter_words,
+                                   const int32_t* folded_filter_sums, int tap,
+                                   int taps, int depth_words,
+                                   int output_depth, int32_t* column) {
+  const int row_stride_words = taps * depth_words;
+  const PackedInt8x4* w = filter_words + tap * depth_words;
+  const int32_t* sums = folded_filter_sums + tap;
+  int out_c = 0;
+  for (; out_c + 4 <= output_depth; out_c += 4) {
+    FullyConnectedFourRows(in, w + out_c * row_stride_words, row_stride_words,
+                           depth_words, sums + out_c * taps, taps,
+                           column + out_c);
+  }
+  for (; out_c < output_depth; ++out_c) {
+    column[out_c] = FullyConnectedOneRow(in, w + out_c * row_stride_words,
+                                         depth_words, sums[out_c * taps]);
+  }
+}
+
+inline int8_t TransposeConvRequantize(int32_t acc, const int32_t* bias_data,
+                                      int out_c,
+                                      const int32_t* output_multiplier,
+                                      const int32_t* output_shift,
+                                      const ConvParams& params) {
+  if (bias_data) {
+    acc += bias_data[out_c];
+  }
+  return FullyConnectedRequantize(
+      acc, output_multiplier[out_c], output_shift[out_c], params.output_offset,
+      params.quantized_activation_min, params.quantized_activation_max);
+}
+
+// Stride 2, 2x2 filter, no padding and an output exactly twice the input:
+// every output pixel gets exactly one tap, so each column is requantized
+// straight into the output and the scratch buffer is not used.
+inline bool TransposeConvIsStride2x2(const ConvParams& params,
+                                     const RuntimeShape& input_shape,
+                                     const RuntimeShape& filter_shape,
+                                     const RuntimeShape& output_shape) {
+  return params.stride_width == 2 && params.stride_height == 2 &&
+         params.padding_values.width == 0 &&
+         params.padding_values.height == 0 && filter_shape.Dims(1) == 2 &&
+         filter_shape.Dims(2) == 2 &&
+         output_shape.Dims(1) == 2 * input_shape.Dims(1) &&
+         output_shape.Dims(2) == 2 * input_shape.Dims(2);
+}
+
+inline void TransposeConvStride2x2(
+    const ConvParams& params, const int32_t* folded_filter_sums,
+    const int32_t* output_multiplier, const int32_t* output_shift,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const int8_t* filter_data, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    int32_t* column) {
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int depth_words = input_shape.Dims(3) / 4;
+  const int output_depth = output_shape.Dims(3);
+  const PackedInt8x4* in = reinterpret_cast<const PackedInt8x4*>(input_data);
+  const PackedInt8x4* filter_words =
+      reinterpret_cast<const PackedInt8x4*>(filter_data);
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int in_y = 0; in_y < input_height; ++in_y) {
+      for (int in_x = 0; in_x < input_width; ++in_x, in += depth_words) {
+        for (int tap = 0; tap < 4; ++tap) {
+          const int out_y = 2 * in_y + tap / 2;
+          const int out_x = 2 * in_x + tap % 2;
+          TransposeConvTapColumn(in, filter_words, folded_filter_sums, tap, 4,
+                                 depth_words, output_depth, column);
+          int8_t* out =
+              output_data + Offset(output_shape, batch, out_y, out_x, 0);
+          for (int out_c = 0; out_c < output_depth; ++out_c) {
+            out[out_c] =
+                TransposeConvRequantize(column[out_c], bias_data, out_c,
+                                        output_multiplier, output_shift, params);
+          }
+        }
+      }
+    }
+  }
+}
+
+// scratch_buffer holds output_shape.FlatSize() + output_depth int32 values:
+// the col2im accumulators followed by one column.
+inline void TransposeConvBlocked(
+    const ConvParams& params, const int32_t* folded_filter_sums,
+    const int32_t* output_multiplier, const int32_t* output_shift,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& filter_shape, const int8_t* filter_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    int32_t* scratch_buffer) {
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_LE(params.quantized_activation_min,
+                   params.quantized_activation_max);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  TFLITE_DCHECK_EQ(input_depth % 4, 0);
+  const int num_elements = output_shape.FlatSize();
+  int32_t* column = scratch_buffer + num_elements;
+
+  if (TransposeConvIsStride2x2(params, input_shape, filter_shape,
+                               output_shape)) {
+    TransposeConvStride2x2(params, folded_filter_sums, output_multiplier,
+                           output_shift, input_shape, input_data, filter_data,
+                           bias_data, output_shape, output_data, column);
+    return;
+  }
+
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int taps = filter_height * filter_width;
+  const int depth_words = input_depth / 4;
+  const PackedInt8x4* in = reinterpret_cast<const PackedInt8x4*>(input_data);
+  const PackedInt8x4* filter_words =
+      reinterpret_cast<const PackedInt8x4*>(filter_data);
+
+  memset(scratch_buffer, 0, num_elements * sizeof(int32_t));
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int in_y = 0; in_y < input_height; ++in_y) {
+      const int out_y_origin = (in_y * stride_height) - pad_height;
+      for (int in_x = 0; in_x < input_width; ++in_x, in += depth_words) {
+        const int out_x_origin = (in_x * stride_width) - pad_width;
+        for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+          const int out_y = out_y_origin + filter_y;
+          if (out_y < 0 || out_y >= output_height) continue;
+          for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+            const int out_x = out_x_origin + filter_x;
+            if (out_x < 0 || out_x >= output_width) continue;
+            TransposeConvTapColumn(in, filter_words, folded_filter_sums,
+                                   filter_y * filter_width + filter_x, taps,
+                                   depth_words, output_depth, column);
+            int32_t* acc =
+                scratch_buffer + Offset(output_shape, batch, out_y, out_x, 0);
+            for (int out_c = 0; out_c < output_depth; ++out_c) {
+              acc[out_c] += column[out_c];
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < num_elements; i += output_depth) {
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      output_data[i + out_c] = TransposeConvRequantize(
+          scratch_buffer[i + out_c], bias_data, out_c, output_multiplier,
+          output_shift, params);
+    }
+  }
+}
+
+// int16_t input (zero_point=0), int8_t filter, int32 or int64 accumulator
+template <typename Scalar>
+inline void TransposeConv(
+    const ConvParams& params, const int32_t* output_multiplier,
+    const int32_t* output_shift, const RuntimeShape& input_shape,
+    const int16_t* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const RuntimeShape& bias_shape,
+    const Scalar* bias_data, const RuntimeShape& output_shape,
+    int16_t* output_data, const RuntimeShape& im2col_shape, int8_t* im2col_data,
+    Scalar* scratch_buffer) {
+  const int stride_width = params.stride_width;
+  const int stride_height = params.stride_height;
+  const int pad_width = params.padding_values.width;
+  const int pad_height = params.padding_values.height;
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+  (void)im2col_data;   // only used in optimized code.
+  (void)im2col_shape;  // only used in optimized code.
+
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_depth = MatchingDim(input_shape, 3, filter_shape, 3);
+  const int output_depth = MatchingDim(filter_shape, 0, output_shape, 3);
+  if (bias_data) {
+    TFLITE_DCHECK_EQ(bias_shape.FlatSize(), output_depth);
+  }
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int filter_height = filter_shape.Dims(1);
+  const int filter_width = filter_shape.Dims(2);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+  TFLITE_DCHECK_LE(output_activation_min, output_activation_max);
+
+  const int num_elements = output_shape.FlatSize();
+  // We need to initialize scratch_buffer to all 0s, as we apply the same
+  // 'scatter' based trick as in float version.
+  memset(scratch_buffer, 0, num_elements * sizeof(Scalar));
+
+  // Loop through input elements one at a time.
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int in_y = 0; in_y < input_height; ++in_y) {
+      for (int in_x = 0; in_x < input_width; ++in_x) {
+        for (int in_channel = 0; in_channel < input_depth; ++in_channel) {
+          // Loop through the output elements it will influence.
+          const int out_x_origin = (in_x * stride_width) - pad_width;
+          const int out_y_origin = (in_y * stride_height) - pad_height;
+          for (int filter_y = 0; filter_y < filter_height; ++filter_y) {
+            for (int filter_x = 0; filter_x < filter_width; ++filter_x) {
+              for (int out_channel = 0; out_channel < output_depth;
+                   ++out_channel) {
+                // Compute output element location.
+                const int out_x = out_x_origin + filter_x;
+                const int out_y = out_y_origin + filter_y;
+                // We cannot accumulate out of bounds.
+                if ((out_x >= 0) && (out_x < output_width) && (out_y >= 0) &&
+                    (out_y < output_height)) {
+                  const int32_t input_value = input_data[Offset(
+                      input_shape, batch, in_y, in_x, in_channel)];
+                  const int32_t filter_value =
+                      filter_data[Offset(filter_shape, out_channel, filter_y,
+                                         filter_x, in_channel)];
+                  scratch_buffer[Offset(output_shape, batch, out_y, out_x,
+                                        out_channel)] +=
+                      input_value * filter_value;
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int batch = 0; batch < batches; ++batch) {
+    for (int out_y = 0; out_y < output_height; ++out_y) {
+      for (int out_x = 0; out_x < output_width; ++out_x) {
+        for (int out_channel = 0; out_channel < output_depth; ++out_channel) {
+          Scalar acc = scratch_buffer[Offset(output_shape, batch, out_y, out_x,
+                                             out_channel)];
+          if (bias_data) {
+            acc += bias_data[out_channel];
+          }
+          int32_t scaled_acc = MultiplyByQuantizedMultiplier(
+              acc, output_multiplier[out_channel], output_shift[out_channel]);
+          scaled_acc = std::max(scaled_acc, output_activation_min);
+          scaled_acc = std::min(scaled_acc, output_activation_max);
+          output_data[Offset(output_shape, batch, out_y, out_x, out_channel)] =
+              static_cast<int16_t>(scaled_acc);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace reference_integer_ops
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_REFERENCE_INTEGER_OPS_TRANSPOSE_CONV_H_
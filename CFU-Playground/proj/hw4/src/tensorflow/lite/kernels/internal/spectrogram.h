@@ -0,0 +1,167 @@
+
+
+
+
+/* Copyright 2018 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Class for generating spectrogram slices from a waveform.
+// Initialize() should be called before calls to other functions.  Once
+// Initialize() has been called and returned true, The Compute*() functions can
+// be called repeatedly with sequential input data (ie. the first element of the
+// next input vector directly follows the last element of the previous input
+// vector). Whenever enough audio samples are buffered to produce a
+// new frame, it will be placed in output. Output is cleared on each
+// call to Compute*(). This class is thread-unsafe, and should only be
+// called from one thread at a time.
+// With the default parameters, the output of this class should be very
+// close to the results of the following MATLAB code:
+// overlap_samples = window_length_samples - step_samples;
+// window = hann(window_length_samples, 'periodic');
+// S = abs(spectrogram(audio, window, overlap_samples)).^2;
+
+#ifndef TENSORFLOW_LITE_KERNELS_INTERNAL_SPECTROGRAM_H_
+#define TENSORFLOW_LITE_KERNELS_INTERNAL_SPECTROGRAM_H_
+
+#include <complex>
+
+#include "third_party/fft2d/fft.h"
+
+namespace tflite {
+namespace internal {
+
+// Real is the type used for the window, the FFT and the power computation.
+// Spectrogram<double> is the original port and runs the fft2d rdft();
+// Spectrogram<float> keeps everything in single precision and uses its own
+// radix-2 real FFT, avoiding the soft-float double routines on RV32IM.
+template <class Real>
+class Spectrogram {
+ public:
+  Spectrogram() : initialized_(false) {}
+  ~Spectrogram() {}
+
+  // Initializes the class with a given window length and step length
+  // (both in samples). Internally a Hann window is used as the window
+  // function. Returns true on success, after which calls to Process()
+  // are possible. window_length must be greater than 1 and step
+  // length must be greater than 0.
+  // Initialize with an explicit window instead of a length.
+    bool Initialize(int window_length, int step_length, int input_length, int fft_length, int output_frequency_channels);
+
+
+  // Processes an arbitrary amount of audio data (contained in input)
+  // to yield complex spectrogram frames. After a successful call to
+  // Initialize(), Process() may be called repeatedly with new input data
+  // each time.  The audio input is buffered internally, and the output
+  // vector is populated with as many temporally-ordered spectral slices
+  // as it is possible to generate from the input.  The output is cleared
+  // on each call before the new frames (if any) are added.
+  // The template parameters can be float or double.
+  /*
+  template <class InputSample, class OutputSample>
+  bool ComputeComplexSpectrogram(
+      //const std::vector<InputSample>& input,
+      const InputSample* input,
+      //std::vector<std::vector<std::complex<OutputSample>>>* output);
+      std::complex<OutputSample> *output );
+  */
+
+  // This function works as the one above, but returns the power
+  // (the L2 norm, or the squared magnitude) of each complex value.
+  template <class InputSample, class OutputSample>
+  bool ComputeSquaredMagnitudeSpectrogram(
+      //const std::vector<InputSample>& input,
+      const InputSample* input,
+      //std::vector<std::vector<OutputSample>>* output
+      OutputSample* output );
+
+  // Return reference to the window function used internally.
+  //const double* GetWindow() const { return window_; }
+
+  // Return the number of frequency channels in the spectrogram.
+  int output_frequency_channels() const { return output_frequency_channels_; }
+  //float * get_input_for_channel_()  { return input_for_channel_; }
+  //float * get_spectrogram_output_()  { return reinterpret_cast<float *>(spectrogram_output_); }
+
+ private:
+  template <class InputSample>
+  bool GetNextWindowOfSamples(
+    //const std::vector<InputSample>& input,
+    const InputSample* input,
+    int* input_start);
+  void ProcessCoreFFT();
+  void InitializeFFT();
+
+  int fft_length_;
+  int output_frequency_channels_;
+  int window_length_;
+  int step_length_;
+  bool initialized_;
+  int samples_to_next_step_;
+
+  
+  //std::vector<double> window_;
+  //std::vector<double> fft_input_output_;
+  //std::deque<double> input_queue_;
+  Real window_[640];
+  Real fft_input_output_[1026];
+  // Only ever holds one window of samples, so it is sized like window_.
+  float input_queue_[640];
+
+  // Working data areas for the FFT routines.
+  //std::vector<int> fft_integer_working_area_;
+  //std::vector<double> fft_double_working_area_;
+  // rdft() keeps its bit reversal table in fft_integer_working_area_ and its
+  // sin/cos table in fft_working_area_. The float FFT only uses
+  // fft_working_area_, for a half-period cosine table of fft_length_ / 2.
+  int fft_integer_working_area_[24];
+  Real fft_working_area_[512];
+
+  int cur_output;
+  int input_length_;
+};
+
+/*
+// Explicit instantiations in spectrogram.cc.
+extern template bool Spectrogram::ComputeComplexSpectrogram(
+    const float* input,
+    std::complex<float> *);
+extern template bool Spectrogram::ComputeComplexSpectrogram(
+    const double* input,
+    std::complex<float> *);
+extern template bool Spectrogram::ComputeComplexSpectrogram(
+    const float* input,
+    std::complex<double> *);
+extern template bool Spectrogram::ComputeComplexSpectrogram(
+    const double* input,
+    std::complex<double> *);
+*/
+
+extern template bool Spectrogram<double>::ComputeSquaredMagnitudeSpectrogram(
+    const float* input, float *);
+extern template bool Spectrogram<double>::ComputeSquaredMagnitudeSpectrogram(
+    const double* input, float *);
+extern template bool Spectrogram<double>::ComputeSquaredMagnitudeSpectrogram(
+    const float* input, double *);
+extern template bool Spectrogram<double>::ComputeSquaredMagnitudeSpectrogram(
+    const double* input, double *);
+extern template bool Spectrogram<float>::ComputeSquaredMagnitudeSpectrogram(
+    const float* input, float *);
+
+
+}  // namespace internal
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_INTERNAL_SPECTROGRAM_H_
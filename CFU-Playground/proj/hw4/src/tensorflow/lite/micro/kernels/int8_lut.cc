@@ -0,0 +1,72 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/kernels/int8_lut.h"
+
+#include "tensorflow/lite/kernels/internal/packed_int8.h"
+#include "tensorflow/lite/micro/micro_context.h"
+
+namespace tflite {
+
+bool Int8LutApplies(TfLiteContext* context, TfLiteNode* node) {
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, 0);
+  TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, 0);
+  const bool applies = input != nullptr && output != nullptr &&
+                       input->type == kTfLiteInt8 &&
+                       output->type == kTfLiteInt8;
+  if (input != nullptr) micro_context->DeallocateTempTfLiteTensor(input);
+  if (output != nullptr) micro_context->DeallocateTempTfLiteTensor(output);
+  return applies;
+}
+
+void EvalInt8Lut(const int8_t* lut, const int8_t* input, int8_t* output,
+                 int size) {
+  const uint8_t* in = reinterpret_cast<const uint8_t*>(input);
+  int i = 0;
+  if (((reinterpret_cast<uintptr_t>(input) |
+        reinterpret_cast<uintptr_t>(output)) &
+       3) == 0) {
+    // One word in, one word out.
+    const PackedInt8x4* in_words = reinterpret_cast<const PackedInt8x4*>(input);
+    PackedInt8x4* out_words = reinterpret_cast<PackedInt8x4*>(output);
+    for (; i + 4 <= size; i += 4) {
+      const uint32_t word = *in_words++;
+      *out_words++ =
+          static_cast<uint32_t>(static_cast<uint8_t>(lut[word & 0xff])) |
+          static_cast<uint32_t>(static_cast<uint8_t>(lut[(word >> 8) & 0xff]))
+              << 8 |
+          static_cast<uint32_t>(static_cast<uint8_t>(lut[(word >> 16) & 0xff]))
+              << 16 |
+          static_cast<uint32_t>(static_cast<uint8_t>(lut[word >> 24])) << 24;
+    }
+  } else {
+    for (; i + 4 <= size; i += 4) {
+      const int8_t a = lut[in[i]];
+      const int8_t b = lut[in[i + 1]];
+      const int8_t c = lut[in[i + 2]];
+      const int8_t d = lut[in[i + 3]];
+      output[i] = a;
+      output[i + 1] = b;
+      output[i + 2] = c;
+      output[i + 3] = d;
+    }
+  }
+  for (; i < size; ++i) {
+    output[i] = lut[in[i]];
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,117 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_KERNELS_INT8_LUT_H_
+#define TENSORFLOW_LITE_MICRO_KERNELS_INT8_LUT_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+
+namespace tflite {
+
+// An int8 -> int8 elementwise op is a function of 256 input values. These
+// helpers let such a kernel run its reference implementation once in Prepare
+// to fill a 256-byte table, and turn Eval into one lookup per element.
+
+constexpr int kInt8LutSize = 256;
+
+// True when input 0 and output 0 of the node are both int8. Call from
+// Prepare.
+bool Int8LutApplies(TfLiteContext* context, TfLiteNode* node);
+
+// Allocates a persistent table and fills it by calling
+// reference(const int8_t* input, int8_t* output, int size) on all 256 int8
+// values, so that lookups are bit-exact with the reference. The table is
+// indexed by the input byte as uint8_t.
+template <typename Reference>
+TfLiteStatus PopulateInt8Lut(TfLiteContext* context, Reference reference,
+                             int8_t** lut) {
+  int8_t* table = static_cast<int8_t*>(
+      context->AllocatePersistentBuffer(context, kInt8LutSize));
+  TF_LITE_ENSURE(context, table != nullptr);
+  int8_t inputs[kInt8LutSize];
+  for (int i = 0; i < kInt8LutSize; ++i) {
+    inputs[i] = static_cast<int8_t>(i);
+  }
+  reference(inputs, table, kInt8LutSize);
+  *lut = table;
+  return kTfLiteOk;
+}
+
+// output[i] = lut[uint8_t(input[i])], four elements per iteration.
+void EvalInt8Lut(const int8_t* lut, const int8_t* input, int8_t* output,
+                 int size);
+
+// A table added to a stock kernel lives next to the stock OpData in the node's
+// user_data. The stock OpData is the first member, so the stock Prepare and
+// Eval, which cast user_data to OpData*, still find their data in place, and
+// only Init changes size. lut stays nullptr unless Prepare filled a table,
+// for example because the node is not int8 -> int8.
+template <typename OpData, typename Entry = int8_t>
+struct Int8LutOpData {
+  OpData data;
+  Entry* lut;
+};
+
+template <typename OpData, typename Entry = int8_t>
+void* Int8LutInit(TfLiteContext* context, const char* buffer, size_t length) {
+  TFLITE_DCHECK(context->AllocatePersistentBuffer != nullptr);
+  return context->AllocatePersistentBuffer(
+      context, sizeof(Int8LutOpData<OpData, Entry>));
+}
+
+// Prepare of an elementwise kernel: runs the stock Prepare, then, for an
+// int8 -> int8 node, fills the table by calling
+// Reference(data, input, output, size).
+template <typename OpData, TfLiteStatus (*Prepare)(TfLiteContext*, TfLiteNode*),
+          void (*Reference)(const OpData&, const int8_t*, int8_t*, int)>
+TfLiteStatus Int8LutPrepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_OK(context, Prepare(context, node));
+
+  auto* op_data = static_cast<Int8LutOpData<OpData>*>(node->user_data);
+  op_data->lut = nullptr;
+  if (!Int8LutApplies(context, node)) return kTfLiteOk;
+  const OpData& data = op_data->data;
+  return PopulateInt8Lut(
+      context,
+      [&data](const int8_t* input, int8_t* output, int size) {
+        Reference(data, input, output, size);
+      },
+      &op_data->lut);
+}
+
+// Eval of an elementwise kernel: looks input 0 up in the table into output 0
+// when Prepare filled one, and runs the stock Eval otherwise.
+template <typename OpData, TfLiteStatus (*Eval)(TfLiteContext*, TfLiteNode*)>
+TfLiteStatus Int8LutEval(TfLiteContext* context, TfLiteNode* node) {
+  const auto* op_data =
+      static_cast<const Int8LutOpData<OpData>*>(node->user_data);
+  if (op_data->lut == nullptr) return Eval(context, node);
+
+  const TfLiteEvalTensor* input = micro::GetEvalInput(context, node, 0);
+  TfLiteEvalTensor* output = micro::GetEvalOutput(context, node, 0);
+  EvalInt8Lut(op_data->lut, micro::GetTensorData<int8_t>(input),
+              micro::GetTensorData<int8_t>(output),
+              MatchingFlatSize(micro::GetTensorShape(input),
+                               micro::GetTensorShape(output)));
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_KERNELS_INT8_LUT_H_
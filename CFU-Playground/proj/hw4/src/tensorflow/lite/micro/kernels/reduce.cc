@@ -0,0 +1,161 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/kernels/internal/reference/reduce.h"
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/quantization_util.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/mean.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/internal/types.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/kernel_util.h"
+#include "tensorflow/lite/micro/kernels/reduce.h"
+#include "tensorflow/lite/micro/micro_utils.h"
+
+namespace tflite {
+
+void* InitReduce(TfLiteContext* context, const char* buffer, size_t length) {
+  return context->AllocatePersistentBuffer(context, sizeof(OpDataReduce));
+}
+
+TfLiteStatus PrepareMax(TfLiteContext* context, TfLiteNode* node) {
+  return PrepareMaxHelper(context, node,
+                          static_cast<OpDataReduce*>(node->user_data));
+}
+
+TfLiteStatus PrepareMeanOrSum(TfLiteContext* context, TfLiteNode* node) {
+  return PrepareMeanOrSumHelper(context, node,
+                                static_cast<OpDataReduce*>(node->user_data));
+}
+
+namespace {
+
+// MEAN keeps the OpDataReduce of the shared helpers, which get a pointer to
+// it, next to the data of its own fast path.
+struct OpDataMean {
+  OpDataReduce reduce;
+  // Set for an int8 NHWC mean over a constant axis {1, 2}, which then runs
+  // MeanOverHeightWidth with this multiplier and shift.
+  bool height_width;
+  int32_t height_width_multiplier;
+  int height_width_shift;
+};
+
+// True when axis is a constant holding exactly the axes 1 and 2 of a 4D
+// input, in either order, as positive or negative indices.
+bool IsHeightWidthAxis(const TfLiteTensor* axis) {
+  if (!IsConstantTensor(axis) || NumElements(axis) != 2) return false;
+  const int32_t* axis_data = GetTensorData<int32_t>(axis);
+  const int a0 = axis_data[0] < 0 ? axis_data[0] + 4 : axis_data[0];
+  const int a1 = axis_data[1] < 0 ? axis_data[1] + 4 : axis_data[1];
+  return (a0 == 1 && a1 == 2) || (a0 == 2 && a1 == 1);
+}
+
+void* InitMean(TfLiteContext* context, const char* buffer, size_t length) {
+  return context->AllocatePersistentBuffer(context, sizeof(OpDataMean));
+}
+
+TfLiteStatus PrepareMean(TfLiteContext* context, TfLiteNode* node) {
+  OpDataMean* op_data = static_cast<OpDataMean*>(node->user_data);
+  TF_LITE_ENSURE_OK(context,
+                    PrepareMeanOrSumHelper(context, node, &op_data->reduce));
+
+  MicroContext* micro_context = GetMicroContext(context);
+  TfLiteTensor* input = micro_context->AllocateTempInputTensor(node, 0);
+  TF_LITE_ENSURE(context, input != nullptr);
+  TfLiteTensor* axis = micro_context->AllocateTempInputTensor(node, 1);
+  TF_LITE_ENSURE(context, axis != nullptr);
+  TfLiteTensor* output = micro_context->AllocateTempOutputTensor(node, 0);
+  TF_LITE_ENSURE(context, output != nullptr);
+
+  op_data->height_width = false;
+  if (input->type == kTfLiteInt8 && output->type == kTfLiteInt8 &&
+      NumDimensions(input) == 4 && IsHeightWidthAxis(axis)) {
+    const int num_pixels =
+        SizeOfDimension(input, 1) * SizeOfDimension(input, 2);
+    // An empty reduction is left to the helper.
+    if (num_pixels > 0) {
+      const double real_multiplier =
+          static_cast<double>(input->params.scale) /
+          (static_cast<double>(output->params.scale) * num_pixels);
+      QuantizeMultiplier(real_multiplier, &op_data->height_width_multiplier,
+                         &op_data->height_width_shift);
+      // MultiplyByQuantizedMultiplier takes right shifts of up to 31.
+      op_data->height_width = op_data->height_width_shift >= -31;
+    }
+  }
+
+  micro_context->DeallocateTempTfLiteTensor(input);
+  micro_context->DeallocateTempTfLiteTensor(axis);
+  micro_context->DeallocateTempTfLiteTensor(output);
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+TfLiteStatus EvalMean(TfLiteContext* context, TfLiteNode* node) {
+  OpDataMean* op_data = static_cast<OpDataMean*>(node->user_data);
+  if (op_data->height_width) {
+    const TfLiteEvalTensor* input =
+        tflite::micro::GetEvalInput(context, node, 0);
+    TfLiteEvalTensor* output = tflite::micro::GetEvalOutput(context, node, 0);
+    reference_integer_ops::MeanOverHeightWidth(
+        op_data->height_width_multiplier, op_data->height_width_shift,
+        tflite::micro::GetTensorShape(input),
+        tflite::micro::GetTensorData<int8_t>(input), op_data->reduce.input_zp,
+        tflite::micro::GetTensorData<int8_t>(output),
+        op_data->reduce.output_zp);
+    return kTfLiteOk;
+  }
+  return EvalMeanHelper(context, node, &op_data->reduce);
+}
+
+TfLiteStatus EvalMax(TfLiteContext* context, TfLiteNode* node) {
+  OpDataReduce* op_data = static_cast<OpDataReduce*>(node->user_data);
+  return EvalMaxHelper(context, node, op_data);
+}
+
+TfLiteStatus EvalSum(TfLiteContext* context, TfLiteNode* node) {
+  return EvalSumHelper(context, node,
+                       static_cast<OpDataReduce*>(node->user_data));
+}
+
+TfLiteRegistration Register_MEAN() {
+  return tflite::micro::RegisterOp(InitMean, PrepareMean, EvalMean);
+}
+
+TfLiteRegistration Register_REDUCE_MAX() {
+  return tflite::micro::RegisterOp(InitReduce, PrepareMax, EvalMax);
+}
+/*
+TfLiteRegistration Register_SUM() {
+  return tflite::micro::RegisterOp(InitReduce, PrepareMeanOrSum, EvalSum);
+}
+*/
+TfLiteRegistration Register_SUM() {
+  return {/*init=*/InitReduce,
+          /*free=*/nullptr,
+          /*prepare=*/PrepareMeanOrSum,
+          /*invoke=*/EvalSum,
+          /*profiling_string=*/nullptr,
+          /*builtin_code=*/0,
+          /*custom_name=*/nullptr,
+          /*version=*/0};
+}
+
+
+}  // namespace tflite
@@ -0,0 +1,743 @@
+// Copyright 2021 The CFU-Playground Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SKIP_TFLM
+
+#include "tflite.h"
+
+#include <cstdint>
+
+#include "op_profile.h"
+#include "perf.h"
+#include "playground_util/random.h"
+#include "proj_tflite.h"
+#include "soft_float_profile.h"
+#include "tensorflow/lite/core/api/error_reporter_macro.h"
+#include "tensorflow/lite/micro/all_ops_resolver.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/micro/micro_profiler.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include "tflite_unit_tests.h"
+#include "xip_models.h"
+
+#if defined(TF_LITE_SHOW_MEMORY_USE) || defined(TF_LITE_ARENA_SIZING)
+#include "tensorflow/lite/micro/recording_micro_interpreter.h"
+#define INTERPRETER_TYPE RecordingMicroInterpreter
+#define ALLOCATOR_TYPE RecordingMicroAllocator
+#else
+#define INTERPRETER_TYPE MicroInterpreter
+#define ALLOCATOR_TYPE MicroAllocator
+#endif
+
+// For C++ exceptions
+void* __dso_handle = &__dso_handle;
+
+//
+// TfLM global objects
+namespace {
+
+// Set while tflite_classify_batch() or a step of tflite_classify_step()
+// runs, which neither print nor profile per operator.
+bool quiet_inference = false;
+
+// A profiler that prints a "." for each profile event begun. It also times
+// each op for op_profile.h when that is enabled.
+class ProgressProfiler : public tflite::MicroProfiler {
+   public:
+    virtual uint32_t BeginEvent(const char* tag) {
+        if (quiet_inference) {
+            return 0;
+        }
+#ifndef HIDE_PROGRESS_DOTS
+        printf(".");
+#endif
+        uint32_t handle = tflite::MicroProfiler::BeginEvent(tag);
+#ifdef SOFT_FLOAT_PROFILE
+        if (handle < kMaxSoftFloatEvents) {
+            num_soft_float_events_ = handle + 1;
+            soft_float_events_[handle] = {tag, soft_float_calls,
+                                          soft_float_cycles,
+                                          perf_get_mcycle()};
+        }
+#endif
+        if (op_profile_enabled) {
+            op_profile_begin(tag);
+        }
+        return handle;
+    }
+
+    virtual void EndEvent(uint32_t event_handle) {
+        if (quiet_inference) {
+            return;
+        }
+        if (op_profile_enabled) {
+            op_profile_end();
+        }
+#ifdef SOFT_FLOAT_PROFILE
+        if (event_handle < kMaxSoftFloatEvents) {
+            SoftFloatEvent& event = soft_float_events_[event_handle];
+            event.cycles = perf_get_mcycle() - event.cycles;
+            event.soft_float_calls = soft_float_calls - event.soft_float_calls;
+            event.soft_float_cycles =
+                soft_float_cycles - event.soft_float_cycles;
+        }
+#endif
+        tflite::MicroProfiler::EndEvent(event_handle);
+    }
+
+#ifdef SOFT_FLOAT_PROFILE
+    // Prints, for each op, the cycles spent inside soft-float helpers.
+    void LogSoftFloatCsv() const {
+        printf("\"Event\",\"Tag\",\"Ticks\",\"Soft-float ticks\","
+               "\"Soft-float calls\",\"Soft-float %%\"\n");
+        for (uint32_t i = 0; i < num_soft_float_events_; i++) {
+            const SoftFloatEvent& event = soft_float_events_[i];
+            printf("%lu,%s,%lu,%lu,%lu,%lu\n", static_cast<unsigned long>(i),
+                   event.tag, static_cast<unsigned long>(event.cycles),
+                   static_cast<unsigned long>(event.soft_float_cycles),
+                   static_cast<unsigned long>(event.soft_float_calls),
+                   static_cast<unsigned long>(
+                       event.cycles ? uint64_t{event.soft_float_cycles} * 100 /
+                                          event.cycles
+                                    : 0));
+        }
+    }
+#endif
+
+   private:
+#ifdef SOFT_FLOAT_PROFILE
+    // Until EndEvent, the counters hold their values at BeginEvent.
+    struct SoftFloatEvent {
+        const char* tag;
+        uint32_t soft_float_calls;
+        uint32_t soft_float_cycles;
+        uint32_t cycles;
+    };
+    static constexpr uint32_t kMaxSoftFloatEvents = 64;
+    SoftFloatEvent soft_float_events_[kMaxSoftFloatEvents];
+    uint32_t num_soft_float_events_ = 0;
+#endif
+
+    TF_LITE_REMOVE_VIRTUAL_DELETE;
+};
+
+tflite::ErrorReporter* error_reporter = nullptr;
+tflite::MicroOpResolver* op_resolver = nullptr;
+tflite::MicroProfiler* profiler = nullptr;
+
+// The interpreter, with access to the context its kernels see.
+class Interpreter : public tflite::INTERPRETER_TYPE {
+   public:
+    using tflite::INTERPRETER_TYPE::INTERPRETER_TYPE;
+
+    TfLiteContext* kernel_context() {
+        return const_cast<TfLiteContext*>(&context());
+    }
+};
+
+// The selected model.
+const tflite::Model* model = nullptr;
+Interpreter* interpreter = nullptr;
+
+// Models resident in the arena, each with its own interpreter. They share
+// one allocator: their persistent data is stacked in the arena tail and
+// their activations and scratch buffers overlay each other in the head.
+struct ResidentModel {
+    const unsigned char* data;
+    const tflite::Model* model;
+    Interpreter* interpreter;
+    // The arena buffer of input 0, for when a bound input is released.
+    void* input_data;
+};
+constexpr int kMaxResidentModels = 4;
+ResidentModel resident_models[kMaxResidentModels];
+int num_resident_models = 0;
+ResidentModel* selected = nullptr;
+tflite::ALLOCATOR_TYPE* allocator = nullptr;
+
+// C++ 11 does not have a constexpr std::max.
+// For this reason, a small implementation is written.
+template <typename T>
+constexpr T const& const_max(const T& x) {
+    return x;
+}
+
+template <typename T, typename... Args>
+constexpr T const& const_max(const T& x, const T& y, const Args&... rest) {
+    return const_max(x > y ? x : y, rest...);
+}
+
+// Exact arena sizes, measured by a TF_LITE_ARENA_SIZING build in simulation
+// and written by scripts/arena_sizes.py. The Makefile defines
+// MEASURED_ARENA_SIZES when src/arena_sizes.h exists. A sizing build itself
+// uses the guesses below, so that kernels needing more than was measured
+// still fit.
+#if defined(MEASURED_ARENA_SIZES) && !defined(TF_LITE_ARENA_SIZING)
+#include "arena_sizes.h"
+#endif
+
+// Guesses for the models that have not been measured.
+#ifndef TFLITE_ARENA_SIZE_PDTI8
+#define TFLITE_ARENA_SIZE_PDTI8 (81 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MICRO_SPEECH
+#define TFLITE_ARENA_SIZE_MICRO_SPEECH (7 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MAGIC_WAND
+#define TFLITE_ARENA_SIZE_MAGIC_WAND (5 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MNV2
+#define TFLITE_ARENA_SIZE_MNV2 (800 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_HPS
+#define TFLITE_ARENA_SIZE_HPS (256 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_ANOMD
+#define TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_ANOMD (3 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_IMGC
+#define TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_IMGC (53 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_KWS
+#define TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_KWS (23 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_VWW
+#define TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_VWW (99 * 1024)
+#endif
+#ifndef TFLITE_ARENA_SIZE_DS_CNN_STREAM_FE  // LR
+#define TFLITE_ARENA_SIZE_DS_CNN_STREAM_FE (2000 * 1024)
+#endif
+
+// Room for the weights promoted from SPI flash, unless they were measured.
+#if defined(MODELS_IN_SPIFLASH) && \
+    (!defined(MEASURED_ARENA_SIZES) || defined(TF_LITE_ARENA_SIZING))
+#define XIP_ARENA_BYTES XIP_PROMOTE_BYTES
+#else
+#define XIP_ARENA_BYTES 0
+#endif
+
+// Get the smallest kTensorArenaSize possible.
+constexpr int kTensorArenaSize = const_max<int>(
+#ifdef INCLUDE_MODEL_PDTI8
+    TFLITE_ARENA_SIZE_PDTI8,
+#endif
+#ifdef INCLUDE_MODEL_MICRO_SPEECH
+    TFLITE_ARENA_SIZE_MICRO_SPEECH,
+#endif
+#ifdef INCLUDE_MODEL_MAGIC_WAND
+    TFLITE_ARENA_SIZE_MAGIC_WAND,
+#endif
+#ifdef INCLUDE_MODEL_MNV2
+    TFLITE_ARENA_SIZE_MNV2,
+#endif
+#ifdef INCLUDE_MODEL_HPS
+    TFLITE_ARENA_SIZE_HPS,
+#endif
+#ifdef INCLUDE_MODEL_MLCOMMONS_TINY_V01_ANOMD
+    TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_ANOMD,
+#endif
+#ifdef INCLUDE_MODEL_MLCOMMONS_TINY_V01_IMGC
+    TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_IMGC,
+#endif
+#ifdef INCLUDE_MODEL_MLCOMMONS_TINY_V01_KWS
+    TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_KWS,
+#endif
+#ifdef INCLUDE_MODEL_MLCOMMONS_TINY_V01_VWW
+    TFLITE_ARENA_SIZE_MLCOMMONS_TINY_V01_VWW,
+#endif
+#ifdef INCLUDE_MODEL_DS_CNN_STREAM_FE
+    TFLITE_ARENA_SIZE_DS_CNN_STREAM_FE,
+#endif
+    0 /* When no models defined, we don't need a tensor arena. */
+) + XIP_ARENA_BYTES;
+
+// TFLM aligns the arena start to 16 bytes. With an aligned arena, the bytes
+// it reports as used are exactly the bytes it needs.
+#ifdef CONFIG_SOC_SEPARATE_ARENA
+alignas(16) static uint8_t tensor_arena[kTensorArenaSize]
+    __attribute__((section(".arena")));
+#else
+alignas(16) static uint8_t tensor_arena[kTensorArenaSize];
+#endif
+}  // anonymous namespace
+
+uint8_t* tflite_tensor_arena = tensor_arena;
+
+static void tflite_init() {
+    static bool initialized = false;
+    if (initialized) {
+        return;
+    }
+    initialized = true;
+
+    // Sets up error reporting etc
+    static tflite::MicroErrorReporter micro_error_reporter;
+    error_reporter = &micro_error_reporter;
+    TF_LITE_REPORT_ERROR(error_reporter, "Error_reporter OK!");
+
+    // Pull in only the operation implementations we need.
+    // This relies on a complete list of all the ops needed by this graph.
+    // An easier approach is to just use the AllOpsResolver, but this will
+    // incur some penalty in code space for op implementations that are not
+    // needed by this graph.
+    //
+    static tflite::AllOpsResolver resolver;
+    op_resolver = &resolver;
+
+    // profiler
+    static ProgressProfiler micro_profiler;
+    profiler = &micro_profiler;
+}
+
+// Destroys every resident interpreter and frees the whole arena.
+static void tflite_unload_all() {
+    for (int i = num_resident_models - 1; i >= 0; i--) {
+        resident_models[i].interpreter->~Interpreter();
+    }
+    num_resident_models = 0;
+    selected = nullptr;
+#ifdef MODELS_IN_SPIFLASH
+    xip_reset_promotions();
+#endif
+    allocator = nullptr;
+    model = nullptr;
+    interpreter = nullptr;
+}
+
+// Builds an interpreter for a model next to the resident ones. Returns its
+// handle, or -1 if it did not fit, after which the allocator must not be
+// used again.
+static int tflite_try_add_model(const unsigned char* model_data,
+                                unsigned int model_length) {
+    tflite_preload(model_data, model_length);
+    if (!allocator) {
+        allocator =
+            tflite::ALLOCATOR_TYPE::Create(tensor_arena, kTensorArenaSize);
+    }
+
+    // Map the model into a usable data structure. This doesn't involve any
+    // copying or parsing, it's a very lightweight operation.
+    const int handle = num_resident_models;
+    ResidentModel& resident = resident_models[handle];
+    resident.data = model_data;
+    resident.model = tflite::GetModel(model_data);
+
+    // Build an interpreter to run the model with.
+    // NOLINTNEXTLINE(runtime-global-variables)
+    alignas(Interpreter) static unsigned char
+        bufs[kMaxResidentModels][sizeof(Interpreter)];
+    resident.interpreter = new (bufs[handle]) Interpreter(
+        resident.model, *op_resolver, allocator, nullptr, profiler);
+
+    // Allocate memory from the tensor_arena for the model's tensors.
+    TfLiteStatus allocate_status = resident.interpreter->AllocateTensors();
+    if (allocate_status != kTfLiteOk) {
+        resident.interpreter->~Interpreter();
+        return -1;
+    }
+    num_resident_models++;
+#ifdef MODELS_IN_SPIFLASH
+    xip_promote_weights(resident.model, resident.interpreter->kernel_context(),
+                        allocator);
+#endif
+
+#ifdef TF_LITE_SHOW_MEMORY_USE
+    allocator->PrintAllocations();
+#endif
+#ifdef TF_LITE_ARENA_SIZING
+    // Parsed by scripts/arena_sizes.py. The figures cover this model and the
+    // ones resident next to it: the head holds the largest of their planned
+    // activations and kernel scratch buffers, the tail the sum of everything
+    // that lives as long as their interpreters, including the kernels'
+    // persistent buffers.
+    {
+        const tflite::RecordingSingleArenaBufferAllocator* arena =
+            allocator->GetSimpleMemoryAllocator();
+        printf("Arena: model %u bytes, %d resident, needs %lu (head %lu, "
+               "tail %lu, persistent buffers %lu)\n",
+               model_length, num_resident_models,
+               static_cast<unsigned long>(
+                   resident.interpreter->arena_used_bytes()),
+               static_cast<unsigned long>(arena->GetNonPersistentUsedBytes()),
+               static_cast<unsigned long>(arena->GetPersistentUsedBytes()),
+               static_cast<unsigned long>(
+                   allocator
+                       ->GetRecordedAllocation(
+                           tflite::RecordedAllocationType::kPersistentBufferData)
+                       .used_bytes));
+    }
+#endif
+
+    // Get information about the memory area to use for the model's input.
+    auto input = resident.interpreter->input(0);
+    resident.input_data = input->data.data;
+    auto dims = input->dims;
+    printf("Input: %d bytes, %d dims:", input->bytes, dims->size);
+    for (int ii = 0; ii < dims->size; ++ii) {
+        printf(" %d", dims->data[ii]);
+    }
+    puts("\n");
+
+    // LR
+    printf("DRAM: %d bytes\n", resident.interpreter->arena_used_bytes());
+    tflite_postload();
+    return handle;
+}
+
+int tflite_add_model(const unsigned char* model_data,
+                     unsigned int model_length) {
+    tflite_init();
+    for (int i = 0; i < num_resident_models; i++) {
+        if (resident_models[i].data == model_data) {
+            return i;
+        }
+    }
+
+    if (num_resident_models == kMaxResidentModels) {
+        tflite_unload_all();
+    }
+    int handle = tflite_try_add_model(model_data, model_length);
+    if (handle < 0 && num_resident_models > 0) {
+        printf("Arena full: unloading %d resident models\n",
+               num_resident_models);
+        tflite_unload_all();
+        handle = tflite_try_add_model(model_data, model_length);
+    }
+    if (handle < 0) {
+        TF_LITE_REPORT_ERROR(error_reporter, "AllocateTensors() failed");
+        tflite_unload_all();
+    }
+    return handle;
+}
+
+void tflite_select_model(int handle) {
+    if (handle < 0 || handle >= num_resident_models) {
+        return;
+    }
+    selected = &resident_models[handle];
+    model = selected->model;
+    interpreter = selected->interpreter;
+    op_profile_set_model(model);
+}
+
+void tflite_load_model(const unsigned char* model_data,
+                       unsigned int model_length) {
+    tflite_init();
+    tflite_unload_all();
+    tflite_select_model(tflite_add_model(model_data, model_length));
+}
+
+// Points input 0 of the selected model, as both the kernels and the
+// functions here see it, at `data`.
+static void point_input(void* data) {
+    TfLiteContext* context = interpreter->kernel_context();
+    context->GetEvalTensor(context, interpreter->inputs().Get(0))->data.data =
+        data;
+    interpreter->input(0)->data.data = data;
+}
+
+// Input 0 of the selected model, back in the arena if it was bound.
+static TfLiteTensor* arena_input() {
+    TfLiteTensor* input = interpreter->input(0);
+    if (input->data.data != selected->input_data) {
+        point_input(selected->input_data);
+    }
+    return input;
+}
+
+bool tflite_bind_input(const void* data, size_t bytes) {
+    TfLiteTensor* input = interpreter->input(0);
+    if (data == nullptr || reinterpret_cast<uintptr_t>(data) % 4 != 0 ||
+        bytes != input->bytes) {
+        printf("Cannot bind input: %d bytes at %p, model wants %d aligned\n",
+               static_cast<int>(bytes), data, static_cast<int>(input->bytes));
+        return false;
+    }
+    point_input(const_cast<void*>(data));
+    return true;
+}
+
+void* tflite_input_buffer(size_t* bytes) {
+    TfLiteTensor* input = arena_input();
+    *bytes = input->bytes;
+    return input->data.data;
+}
+
+void tflite_set_input_zeros(void) {
+    auto input = arena_input();
+    memset(input->data.int8, 0, input->bytes);
+    printf("Zeroed %d bytes at %p\n", input->bytes, input->data.int8);
+}
+
+void tflite_set_input_zeros_float() {
+    auto input = arena_input();
+    memset(input->data.f, 0, input->bytes);
+    printf("Zeroed %d bytes at %p\n", input->bytes, input->data.f);
+}
+
+void tflite_set_input(const void* data) {
+    auto input = arena_input();
+    memcpy(input->data.int8, data, input->bytes);
+    printf("Copied %d bytes at %p\n", input->bytes, input->data.int8);
+}
+
+void tflite_set_input_unsigned(const unsigned char* data) {
+    auto input = arena_input();
+    for (size_t i = 0; i < input->bytes; i++) {
+        input->data.int8[i] = static_cast<int>(data[i]) - 128;
+    }
+    printf("Set %d bytes at %p\n", input->bytes, input->data.int8);
+}
+
+void tflite_set_input_float(const float* data) {
+    auto input = arena_input();
+    memcpy(input->data.f, data, input->bytes);
+    printf("Copied %d bytes at %p\n", input->bytes, input->data.f);
+}
+
+void tflite_randomize_input(int64_t seed) {
+    int64_t r = seed;
+    auto input = arena_input();
+    for (size_t i = 0; i < input->bytes; i++) {
+        input->data.int8[i] = static_cast<int8_t>(next_pseudo_random(&r));
+    }
+    printf("Set %d bytes at %p\n", input->bytes, input->data.int8);
+}
+
+void tflite_set_grid_input(void) {
+    auto input = arena_input();
+    size_t height = input->dims->data[1];
+    size_t width = input->dims->data[2];
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            int8_t val = (y & 0x20) & (x & 0x20) ? -128 : 127;
+            input->data.int8[x + y * width] = val;
+        }
+    }
+    printf("Set %d bytes at %p\n", input->bytes, input->data.int8);
+}
+
+int8_t* tflite_get_output() {
+    return interpreter->output(0)->data.int8;
+}
+
+float* tflite_get_output_float() {
+    return interpreter->output(0)->data.f;
+}
+
+void tflite_classify(int handle) {
+    tflite_select_model(handle);
+    tflite_classify();
+}
+
+void tflite_classify() {
+    // Run the model on this input and make sure it succeeds.
+    profiler->ClearEvents();
+    op_profile_reset();
+    perf_reset_all_counters();
+    if (op_profile_enabled && op_profile_counters_enabled) {
+        op_profile_start_counters();
+    }
+#ifdef SOFT_FLOAT_PROFILE
+    soft_float_profile_reset();
+#endif
+
+    // perf_set_mcycle is a no-op for some boards, start and end used instead.
+    uint64_t start = perf_get_mcycle64();
+    if (kTfLiteOk != interpreter->Invoke()) {
+        puts("Invoke failed.");
+    }
+    uint64_t end = perf_get_mcycle64();
+#ifndef NPROFILE
+    printf("\n");
+    profiler->LogCsv();
+#ifdef SOFT_FLOAT_PROFILE
+    static_cast<ProgressProfiler*>(profiler)->LogSoftFloatCsv();
+    soft_float_profile_print();
+#endif
+    perf_print_all_counters();
+#endif
+    if (op_profile_enabled) {
+        printf("\n");
+        op_profile_print();
+    }
+    perf_print_value(end - start);  // Possible overflow is intentional here.
+    printf(" cycles total\n");
+}
+
+// Cycles of the first invokes of the last batch, for their distribution.
+static constexpr int kMaxBatchLatencies = 256;
+static uint64_t batch_latencies[kMaxBatchLatencies];
+
+// Prints the invoke cycles at `percent` of the sorted latencies.
+static void print_latency_percentile(const char* name, int count,
+                                     int percent) {
+    printf("%s %llu", name,
+           static_cast<unsigned long long>(
+               batch_latencies[(count - 1) * percent / 100]));
+}
+
+void tflite_classify_batch(const void* const* inputs, int n,
+                           void* const* outputs) {
+    // Restored on the way out, so a tflite_bind_input() binding survives.
+    void* const bound_data = interpreter->input(0)->data.data;
+    TfLiteTensor* input = arena_input();
+    const TfLiteTensor* output = interpreter->output(0);
+    const int batch = input->dims->size > 1 && input->dims->data[0] > 1
+                          ? input->dims->data[0]
+                          : 1;
+    const size_t input_bytes = input->bytes / batch;
+    const size_t output_bytes = output->bytes / batch;
+
+    quiet_inference = true;
+    int num_invokes = 0;
+    uint64_t total = 0;
+    for (int i = 0; i < n; i += batch) {
+        const int count = n - i < batch ? n - i : batch;
+        if (batch == 1 && reinterpret_cast<uintptr_t>(inputs[i]) % 4 == 0) {
+            point_input(const_cast<void*>(inputs[i]));
+        } else {
+            // Gather the samples of one invoke, padding a short last batch
+            // with zeros.
+            uint8_t* data = static_cast<uint8_t*>(arena_input()->data.data);
+            for (int j = 0; j < count; j++) {
+                memcpy(data + j * input_bytes, inputs[i + j], input_bytes);
+            }
+            memset(data + count * input_bytes, 0,
+                   (batch - count) * input_bytes);
+        }
+
+        const uint64_t start = perf_get_mcycle64();
+        const TfLiteStatus status = interpreter->Invoke();
+        const uint64_t cycles = perf_get_mcycle64() - start;
+        if (status != kTfLiteOk) {
+            puts("Invoke failed.");
+            break;
+        }
+        if (num_invokes < kMaxBatchLatencies) {
+            batch_latencies[num_invokes] = cycles;
+        }
+        num_invokes++;
+        total += cycles;
+
+        for (int j = 0; outputs != nullptr && j < count; j++) {
+            if (outputs[i + j] != nullptr) {
+                memcpy(outputs[i + j], output->data.int8 + j * output_bytes,
+                       output_bytes);
+            }
+        }
+    }
+    quiet_inference = false;
+    point_input(bound_data);
+    if (num_invokes == 0) {
+        return;
+    }
+
+    const int inferences = num_invokes * batch < n ? num_invokes * batch : n;
+    const uint64_t per_second_x100 =
+        total ? static_cast<uint64_t>(inferences) * CONFIG_CLOCK_FREQUENCY *
+                    100 / total
+              : 0;
+    printf("Batch: %d inferences in %d invokes of %d, ", inferences,
+           num_invokes, batch);
+    perf_print_value(total);
+    printf(" cycles, %lu.%02lu inferences/s at %lu MHz\n",
+           static_cast<unsigned long>(per_second_x100 / 100),
+           static_cast<unsigned long>(per_second_x100 % 100),
+           static_cast<unsigned long>(CONFIG_CLOCK_FREQUENCY / 1000000));
+
+    // Insertion sort; the latencies are few.
+    const int count =
+        num_invokes < kMaxBatchLatencies ? num_invokes : kMaxBatchLatencies;
+    for (int i = 1; i < count; i++) {
+        const uint64_t latency = batch_latencies[i];
+        int j = i;
+        for (; j > 0 && batch_latencies[j - 1] > latency; j--) {
+            batch_latencies[j] = batch_latencies[j - 1];
+        }
+        batch_latencies[j] = latency;
+    }
+    printf("Invoke cycles over %d invokes:", count);
+    print_latency_percentile(" min", count, 0);
+    print_latency_percentile(", median", count, 50);
+    print_latency_percentile(", p90", count, 90);
+    print_latency_percentile(", max", count, 100);
+    printf(", mean %llu\n",
+           static_cast<unsigned long long>(total / num_invokes));
+}
+
+// Cycles of the last step, and of the longest step of the current or last
+// step-wise inference.
+static uint64_t step_cycles = 0;
+static uint64_t max_step_cycles = 0;
+
+// Runs max_ops operators, then one at a time until `cycles` have passed.
+static int classify_step(int max_ops, uint64_t cycles) {
+    if (interpreter->remaining_operators() == 0) {
+        max_step_cycles = 0;
+    }
+    quiet_inference = true;
+    const uint64_t start = perf_get_mcycle64();
+    TfLiteStatus status = interpreter->InvokeStep(max_ops);
+    uint64_t elapsed = perf_get_mcycle64() - start;
+    while (status == kTfLiteOk && interpreter->remaining_operators() > 0 &&
+           elapsed < cycles) {
+        status = interpreter->InvokeStep(1);
+        elapsed = perf_get_mcycle64() - start;
+    }
+    quiet_inference = false;
+
+    step_cycles = elapsed;
+    if (elapsed > max_step_cycles) {
+        max_step_cycles = elapsed;
+    }
+    if (status != kTfLiteOk) {
+        puts("Invoke failed.");
+        return -1;
+    }
+    return interpreter->remaining_operators();
+}
+
+int tflite_classify_step(int max_ops) {
+    if (max_ops < 1) {
+        printf("Cannot step %d operators\n", max_ops);
+        return -1;
+    }
+    return classify_step(max_ops, 0);
+}
+
+int tflite_classify_step_cycles(uint64_t cycles) {
+    return classify_step(1, cycles);
+}
+
+int tflite_remaining_ops(void) {
+    return interpreter->remaining_operators();
+}
+
+uint64_t tflite_step_cycles(void) {
+    return step_cycles;
+}
+
+uint64_t tflite_max_step_cycles(void) {
+    return max_step_cycles;
+}
+
+int8_t* get_input() {
+    return interpreter->input(0)->data.int8;
+}
+
+#endif  // SKIP_TFLM
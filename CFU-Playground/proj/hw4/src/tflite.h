@@ -0,0 +1,115 @@
+/*
+ * Copyright 2021 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Defines tflite functions for evaluating models
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef _TFLITE_H
+#define _TFLITE_H
+
+#ifndef __cplusplus
+#error "tflite.h is for C++ only"
+#endif
+
+// Sets up TfLite with a given model, unloading any others
+void tflite_load_model(const unsigned char* model_data,
+                       unsigned int model_length);
+
+// Keeps several models loaded at once, so that switching between them costs
+// no setup. tflite_add_model() loads a model next to the resident ones and
+// returns its handle; adding a resident model again just returns its handle.
+// It returns -1 if the model does not fit even alone. When the model does
+// not fit next to the others, they are all unloaded first, so re-add a model
+// rather than keeping its handle across other loads. tflite_load_model()
+// also unloads every resident model.
+//
+// The models share the arena's non-persistent memory: running one overwrites
+// the tensors of the others. Set a model's input after running another, and
+// read its output before running another.
+int tflite_add_model(const unsigned char* model_data,
+                     unsigned int model_length);
+
+// Makes a resident model the one that the functions below work on.
+void tflite_select_model(int handle);
+
+void tflite_set_input_zeros(void);
+void tflite_set_input_zeros_float();
+void tflite_set_input(const void* data);
+void tflite_set_input_unsigned(const unsigned char* data);
+void tflite_set_input_float(const float* data);
+void tflite_randomize_input(int64_t seed);
+void tflite_set_grid_input(void);
+
+// Zero-copy input. The selected model reads its input in place from `data`,
+// which must be 4-byte aligned, hold exactly the input's bytes, and stay
+// valid and unchanged while the model runs. Kernels never write their
+// inputs, so `data` may be read-only. Returns false, leaving the input as it
+// was, if `data` does not qualify. The binding lasts until one of the
+// functions above or tflite_input_buffer() is called for the model.
+bool tflite_bind_input(const void* data, size_t bytes);
+
+// Returns the selected model's own input buffer in the arena and sets
+// *bytes, so that a producer can write the input there directly. Like the
+// other tensors, it is only valid until another resident model runs.
+void* tflite_input_buffer(size_t* bytes);
+
+// Run classification with data already set into input.
+void tflite_classify();
+// Same, after selecting a resident model.
+void tflite_classify(int handle);
+
+// Runs the selected model on n inputs back to back, with no printing,
+// profiling or counter resets per inference, then prints the throughput and
+// the distribution of invoke cycles. inputs[i] has the input's bytes per
+// sample and is read in place when it is 4-byte aligned. Output 0 of each
+// sample is copied to outputs[i], unless outputs or outputs[i] is null. A
+// model whose input has a batch dimension above 1 runs that many samples
+// per invoke. An input bound with tflite_bind_input() stays bound.
+void tflite_classify_batch(const void* const* inputs, int n,
+                           void* const* outputs);
+
+// Step-wise inference, so that a main loop can service the UART or audio
+// capture during a long inference. tflite_classify_step() runs at most
+// max_ops (at least 1) operators of the selected model, continuing its
+// inference in progress or starting one on the current input. It returns the
+// operators still to run: zero once the output is ready, -1 if an operator
+// failed or max_ops is below 1.
+// tflite_classify_step_cycles() instead runs operators until `cycles` have
+// passed, which the last one may overrun. Steps neither print nor profile.
+// tflite_classify() and tflite_classify_batch() abandon an inference in
+// progress. Running another resident model before it completes spoils it,
+// as that overwrites its activations.
+int tflite_classify_step(int max_ops);
+int tflite_classify_step_cycles(uint64_t cycles);
+
+// The operators still to run in the selected model's inference in progress.
+int tflite_remaining_ops(void);
+
+// The cycles of the last step, and of the longest step of the current or
+// last step-wise inference: how long it kept the main loop waiting.
+uint64_t tflite_step_cycles(void);
+uint64_t tflite_max_step_cycles(void);
+
+// Obtain the result vector
+int8_t* tflite_get_output();
+float* tflite_get_output_float();
+
+// The arena
+extern uint8_t *tflite_tensor_arena;
+#endif  // _TFLITE_H
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "xip_models.h"
+
+#ifdef MODELS_IN_SPIFLASH
+
+#include <crc.h>
+#include <generated/mem.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "op_profile.h"
+
+#ifndef SPIFLASH_BASE
+#error "MODELS_IN_SPIFLASH needs a board with memory-mapped SPI flash"
+#endif
+
+namespace {
+
+// A weight tensor of the model being promoted, with the bytes it reads per
+// Invoke(), as estimated from the ops that use it.
+struct Candidate {
+  int tensor;
+  const uint8_t* data;
+  uint32_t bytes;
+  uint64_t reads;
+};
+
+constexpr int kMaxCandidates = 128;
+Candidate candidates[kMaxCandidates];
+
+// Bytes promoted for the resident models.
+uint32_t promoted_bytes;
+
+const unsigned char* image() {
+  return reinterpret_cast<const unsigned char*>(SPIFLASH_BASE) +
+         XIP_IMAGE_OFFSET;
+}
+
+// Bytes of SPI flash from the image to the end of the flash.
+uint32_t image_room() {
+  return XIP_IMAGE_OFFSET < SPIFLASH_SIZE
+             ? static_cast<uint32_t>(SPIFLASH_SIZE - XIP_IMAGE_OFFSET)
+             : 0;
+}
+
+// The data of a constant tensor, or nullptr.
+const flatbuffers::Vector<uint8_t>* constant_data(
+    const tflite::Model* model, const tflite::Tensor* tensor) {
+  const tflite::Buffer* buffer = model->buffers()->Get(tensor->buffer());
+  if (buffer == nullptr || buffer->data() == nullptr ||
+      buffer->data()->size() == 0) {
+    return nullptr;
+  }
+  return buffer->data();
+}
+
+int64_t flat_size(const tflite::Tensor* tensor) {
+  if (tensor->shape() == nullptr) return 0;
+  int64_t size = 1;
+  for (int32_t d : *tensor->shape()) size *= d;
+  return size;
+}
+
+}  // anonymous namespace
+
+const unsigned char* xip_find_model(const char* name, unsigned int* length) {
+  const uint32_t room = image_room();
+  uint32_t header[2];
+  if (room >= sizeof(header)) {
+    memcpy(header, image(), sizeof(header));
+  }
+  if (room < sizeof(header) || header[0] != kXipImageMagic) {
+    printf("No model image at offset 0x%08x of SPI flash\n",
+           static_cast<unsigned>(XIP_IMAGE_OFFSET));
+    return nullptr;
+  }
+  if (header[1] > (room - sizeof(header)) / sizeof(XipModelEntry)) {
+    printf("SPI flash image lists %u models, more than fit the flash\n",
+           static_cast<unsigned>(header[1]));
+    return nullptr;
+  }
+
+  const XipModelEntry* entries =
+      reinterpret_cast<const XipModelEntry*>(image() + sizeof(header));
+  for (uint32_t i = 0; i < header[1]; i++) {
+    const XipModelEntry& entry = entries[i];
+    if (strncmp(entry.name, name, sizeof(entry.name)) != 0) continue;
+
+    if (entry.offset > room || entry.length > room - entry.offset) {
+      printf("Model %s runs past the end of SPI flash\n", name);
+      return nullptr;
+    }
+    // Reads the whole model through the flash once per lookup.
+    const unsigned char* data = image() + entry.offset;
+    if (crc32(data, entry.length) != entry.crc) {
+      printf("Model %s in SPI flash fails its CRC\n", name);
+      return nullptr;
+    }
+    *length = entry.length;
+    return data;
+  }
+  printf("No model %s in the SPI flash image\n", name);
+  return nullptr;
+}
+
+bool xip_in_flash(const void* data) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(data);
+  return address >= static_cast<uintptr_t>(SPIFLASH_BASE) &&
+         address - static_cast<uintptr_t>(SPIFLASH_BASE) <
+             static_cast<uintptr_t>(SPIFLASH_SIZE);
+}
+
+void xip_promote_weights(const tflite::Model* model, TfLiteContext* context,
+                         tflite::MicroAllocator* allocator) {
+  if (!xip_in_flash(model)) return;
+
+  // A dot product op reads its weights once per MAC. Other ops read their
+  // constant inputs, such as biases and tables, about once per output.
+  const tflite::SubGraph* subgraph = model->subgraphs()->Get(0);
+  int num_candidates = 0;
+  for (const tflite::Operator* op : *subgraph->operators()) {
+    if (op->inputs() == nullptr || op->outputs() == nullptr) continue;
+    int64_t reads = op_profile_macs(model, op);
+    for (int32_t index : *op->outputs()) {
+      if (index < 0) continue;
+      const int64_t outputs = flat_size(subgraph->tensors()->Get(index));
+      if (outputs > reads) reads = outputs;
+    }
+    for (int32_t index : *op->inputs()) {
+      if (index < 0) continue;
+      const flatbuffers::Vector<uint8_t>* data =
+          constant_data(model, subgraph->tensors()->Get(index));
+      if (data == nullptr) continue;
+      int c = 0;
+      while (c < num_candidates && candidates[c].tensor != index) c++;
+      if (c == num_candidates) {
+        if (num_candidates == kMaxCandidates) continue;
+        candidates[num_candidates++] = {index, data->data(), data->size(), 0};
+      }
+      candidates[c].reads += reads;
+    }
+  }
+
+  // Promote the tensors with the most reads per byte that fit the budget.
+  int num_promoted = 0;
+  uint32_t bytes = 0;
+  for (;;) {
+    int best = -1;
+    for (int c = 0; c < num_candidates; c++) {
+      const Candidate& candidate = candidates[c];
+      if (candidate.data == nullptr ||
+          promoted_bytes + candidate.bytes > XIP_PROMOTE_BYTES) {
+        continue;
+      }
+      if (best < 0 || candidate.reads * candidates[best].bytes >
+                          candidates[best].reads * candidate.bytes) {
+        best = c;
+      }
+    }
+    if (best < 0) break;
+
+    Candidate& candidate = candidates[best];
+    TfLiteEvalTensor* tensor = context->GetEvalTensor(context, candidate.tensor);
+    if (tensor->data.data == candidate.data) {
+      void* copy = allocator->AllocatePersistentBuffer(candidate.bytes);
+      if (copy == nullptr) break;
+      memcpy(copy, candidate.data, candidate.bytes);
+      tensor->data.data = copy;
+      promoted_bytes += candidate.bytes;
+      bytes += candidate.bytes;
+      num_promoted++;
+    }
+    candidate.data = nullptr;
+  }
+  printf("XIP: promoted %d of %d weight tensors (%lu bytes) to the arena\n",
+         num_promoted, num_candidates, static_cast<unsigned long>(bytes));
+}
+
+void xip_reset_promotions(void) { promoted_bytes = 0; }
+
+#endif  // MODELS_IN_SPIFLASH
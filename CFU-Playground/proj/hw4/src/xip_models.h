@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 The CFU-Playground Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _XIP_MODELS_H
+#define _XIP_MODELS_H
+
+// Models executed in place from memory-mapped SPI flash, enabled by defining
+// MODELS_IN_SPIFLASH.
+//
+// scripts/xip_image.py packs .tflite files into an image that is programmed
+// into the flash at XIP_IMAGE_OFFSET. The image starts with a directory:
+//
+//   uint32_t magic;        // kXipImageMagic
+//   uint32_t num_models;
+//   XipModelEntry models[num_models];
+//
+// and each model follows at a 16 byte aligned offset. Models looked up here
+// are not compiled into the binary, so they take no main RAM.
+//
+// Weights read in place cost a flash access on every cache miss. When a
+// model in flash is loaded, xip_promote_weights() copies the weight tensors
+// read most often per byte into the arena tail, up to XIP_PROMOTE_BYTES for
+// all resident models, and points the kernels at the copies.
+
+#include <stdint.h>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/micro_allocator.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#ifndef XIP_IMAGE_OFFSET
+#define XIP_IMAGE_OFFSET (8 * 1024 * 1024)
+#endif
+
+#ifndef XIP_PROMOTE_BYTES
+#define XIP_PROMOTE_BYTES (64 * 1024)
+#endif
+
+constexpr uint32_t kXipImageMagic = 0x4d504958;  // "XIPM" in flash
+
+struct XipModelEntry {
+  // The .tflite file name without extension, NUL padded.
+  char name[24];
+  // From the start of the image.
+  uint32_t offset;
+  uint32_t length;
+  // CRC-32 of the model, as computed by crc32() of libbase and zlib.
+  uint32_t crc;
+};
+
+// Returns the model called `name` in the flash image and sets *length, or
+// returns nullptr if the image has no such model or it fails its CRC.
+const unsigned char* xip_find_model(const char* name, unsigned int* length);
+
+// Whether `data` is in the memory-mapped flash.
+bool xip_in_flash(const void* data);
+
+// Copies weight tensors of subgraph 0 of `model`, which the interpreter
+// owning `context` has just allocated, from flash into persistent buffers of
+// `allocator`, and points their eval tensors at the copies. Does nothing for
+// models in RAM.
+void xip_promote_weights(const tflite::Model* model, TfLiteContext* context,
+                         tflite::MicroAllocator* allocator);
+
+// Restores the whole XIP_PROMOTE_BYTES budget. Called when the arena is
+// emptied.
+void xip_reset_promotions(void);
+
+#endif  // _XIP_MODELS_H